@@ -0,0 +1,74 @@
+/// @file hal_dispatch_benchmark.c
+/// Measures the time of driver calls that go straight to HAL, to compare link-time and runtime HAL binding.
+/// Build it with optimizations enabled (for example `--buildtype=release`). It's built with and without
+/// BTS7960_ENABLE_RUNTIME_HAL macro, and `hal_dispatch_compare.py` prints the difference between both builds.
+
+#include <bts7960/bts7960.h>
+#include <bts7960/hal/mock.h>
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+static uint32_t const BENCHMARK_ITERATIONS = 10000000;
+
+static uint64_t nowNanoseconds(void) {
+  struct timespec now;
+  timespec_get(&now, TIME_UTC);
+  return ((uint64_t)now.tv_sec) * 1000000000u + ((uint64_t)now.tv_nsec);
+}
+
+static void printResult(char const *const name, uint64_t const elapsed) {
+  printf("%-24s %8.2f ns/call\n", name, ((double)elapsed) / BENCHMARK_ITERATIONS);
+}
+
+int main(void) {
+  static BTS7960_HAL_Mock hal;
+  static BTS7960          bts;
+
+#ifdef BTS7960_ENABLE_RUNTIME_HAL
+  hal.base.ops = &BTS7960_HAL_MOCK_OPS;
+  printf("HAL binding: runtime (operations table)\n");
+#else
+  printf("HAL binding: link-time\n");
+#endif
+
+  hal.should_init_succeed = true;
+
+  if (!BTS7960_HAL_initializeHardware(BTS7960_HAL_Mock_toHal(&hal))
+      || BTS7960_initialize(&bts, BTS7960_HAL_Mock_toHal(&hal)) != BTS7960_OK)
+  {
+    fprintf(stderr, "Couldn't initialize the driver\n");
+    return 1;
+  }
+
+  // Results are accumulated and printed, so the calls can't be optimized out.
+  uint32_t checksum = 0;
+
+  uint64_t start = nowNanoseconds();
+  for (uint32_t i = 0; i < BENCHMARK_ITERATIONS; i++) {
+    checksum += BTS7960_setPowerPercentage(&bts, (uint8_t)(i % 101));
+  }
+  printResult("setPowerPercentage", nowNanoseconds() - start);
+
+  start = nowNanoseconds();
+  for (uint32_t i = 0; i < BENCHMARK_ITERATIONS; i++) {
+    uint8_t percentage = 0;
+    checksum += BTS7960_getPowerPercentage(&bts, &percentage) + percentage;
+  }
+  printResult("getPowerPercentage", nowNanoseconds() - start);
+
+  start = nowNanoseconds();
+  for (uint32_t i = 0; i < BENCHMARK_ITERATIONS; i++) {
+    BTS7960_Status status;
+    checksum += BTS7960_getStatus(&bts, &status) + status.current;
+  }
+  printResult("getStatus", nowNanoseconds() - start);
+
+  printf("checksum: %" PRIu32 "\n", checksum);
+
+  BTS7960_deInitialize(&bts);
+  BTS7960_HAL_deInitializeHardware(BTS7960_HAL_Mock_toHal(&hal));
+  return 0;
+}
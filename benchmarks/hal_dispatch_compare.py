@@ -0,0 +1,49 @@
+#!/usr/bin/env python3
+"""HAL dispatch cost comparison for BTS7960 driver.
+
+Runs the HAL dispatch benchmark built with link-time and runtime HAL binding, and prints the time per call of each
+binding and the difference between them, which is the cost of dispatching HAL calls through the operations table.
+"""
+
+import argparse
+import subprocess
+import sys
+
+NS_PER_CALL_SUFFIX = "ns/call"
+
+
+def run_benchmark(executable: str) -> dict[str, float]:
+    """Returns time per call (in nanoseconds) of every benchmarked function."""
+    output = subprocess.run([executable], check=True, capture_output=True, text=True).stdout
+    results = {}
+    for line in output.splitlines():
+        columns = line.split()
+        if len(columns) == 3 and columns[2] == NS_PER_CALL_SUFFIX:
+            results[columns[0]] = float(columns[1])
+    return results
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("link_time", help="benchmark built with link-time HAL binding")
+    parser.add_argument("runtime", help="benchmark built with runtime HAL binding")
+    args = parser.parse_args()
+
+    link_time = run_benchmark(args.link_time)
+    runtime = run_benchmark(args.runtime)
+
+    if not link_time or link_time.keys() != runtime.keys():
+        print("Benchmarks reported different sets of functions", file=sys.stderr)
+        return 1
+
+    print(f"{'function':<24}{'link-time':>12}{'runtime':>12}{'difference':>12}")
+    for name, link_time_ns in link_time.items():
+        runtime_ns = runtime[name]
+        print(f"{name:<24}{link_time_ns:>12.2f}{runtime_ns:>12.2f}{runtime_ns - link_time_ns:>+12.2f}")
+    print(f"(times in {NS_PER_CALL_SUFFIX})")
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -38,17 +38,27 @@ BTS7960_Result BTS7960_advancedInitialize(BTS7960 *const     bts,
     return BTS7960_HAL_ERROR;
   }
 
-  bts->hal                      = hal;
-  bts->current_sense_resistance = current_sense_resistance;
   // U = I * R, current in microamps -> /10^3 to convert result to millivolts
-  bts->fault_voltage            = current_sense_resistance * ((uint32_t)current_in_fault_mode) / 1000;
-  bts->fault_voltage_epsilon    = bts->fault_voltage * ((uint32_t)fault_voltage_tolerance) / 100;
-  bts->fault_voltage_min        = bts->fault_voltage - bts->fault_voltage_epsilon;
+  uint32_t const fault_voltage         = current_sense_resistance * ((uint32_t)current_in_fault_mode) / 1000;
+  uint32_t const fault_voltage_epsilon = fault_voltage * ((uint32_t)fault_voltage_tolerance) / 100;
+
+  bts->hal                      = hal;
+  bts->fault_voltage_min        = fault_voltage - fault_voltage_epsilon;
   bts->current_sense_multiplier = (((uint32_t)current_sense_ratio) * current_sense_resistance / 1000);
+#ifndef BTS7960_DISABLE_CONFIGURATION_STORAGE
+  bts->current_sense_resistance = current_sense_resistance;
+  bts->fault_voltage            = fault_voltage;
+  bts->fault_voltage_epsilon    = fault_voltage_epsilon;
   bts->current_sense_ratio      = current_sense_ratio;
   bts->current_in_fault_mode    = current_in_fault_mode;
   bts->fault_voltage_tolerance  = fault_voltage_tolerance;
-  bts->is_initialized           = true;
+#endif
+#ifdef BTS7960_ENABLE_EVENTS
+  bts->event_handler     = NULL;
+  bts->current_threshold = 0;
+  bts->is_fault_active   = false;
+#endif
+  bts->is_initialized = true;
 
   return BTS7960_OK;
 }
@@ -200,6 +210,81 @@ BTS7960_Result BTS7960_getPowerPercentage(BTS7960 const *const bts, uint8_t *con
   return BTS7960_OK;
 }
 
+#ifdef BTS7960_ENABLE_EMERGENCY_STOP
+BTS7960_Result BTS7960_initializeGroup(BTS7960_Group *const  group,
+                                       BTS7960 *const *const drivers,
+                                       BTS7960_HAL **const   hals,
+                                       size_t const          count) {
+  #ifndef BTS7960_DISABLE_ASSERTS
+  assert(group);
+  assert(drivers);
+  assert(hals);
+  assert(count);
+  #endif
+
+  memset(group, 0, sizeof(BTS7960_Group));
+
+  for (size_t driver = 0; driver < count; driver++) {
+  #ifndef BTS7960_DISABLE_ASSERTS
+    assert(drivers[driver]);
+  #endif
+
+    if (!drivers[driver]->is_initialized) {
+      return BTS7960_NOT_INITIALIZED;
+    }
+
+    hals[driver] = drivers[driver]->hal;
+  }
+
+  #ifdef BTS7960_ENABLE_BATCHED_HAL
+    #ifdef BTS7960_ENABLE_RUNTIME_HAL
+  // Batched operation is dispatched through the first HAL instance, so all of them must share its implementation.
+  bool is_batched = hals[0]->ops->setEnablePinStates != NULL;
+
+  for (size_t driver = 1; driver < count && is_batched; driver++) {
+    is_batched = hals[driver]->ops == hals[0]->ops;
+  }
+    #else
+  bool const is_batched = true;
+    #endif
+  #else
+  bool const is_batched = false;
+  #endif
+
+  // Batched operation may fail, in which case all drivers are disabled one by one, hence the extra operation.
+  group->hals                      = hals;
+  group->count                     = count;
+  group->worst_case_hal_operations = is_batched ? count + 1 : count;
+  group->is_batched                = is_batched;
+  return BTS7960_OK;
+}
+
+BTS7960_Result BTS7960_emergencyStop(BTS7960_Group const *const group) {
+  #ifndef BTS7960_DISABLE_ASSERTS
+  assert(group);
+  assert(group->hals);
+  #endif
+
+  #ifdef BTS7960_ENABLE_BATCHED_HAL
+  if (group->is_batched && BTS7960_HAL_setEnablePinStates(group->hals, group->count, false)) {
+    return BTS7960_OK;
+  }
+  #endif
+
+  // Drivers are validated in BTS7960_initializeGroup, so the HAL is called directly to avoid any extra work between
+  // disabling consecutive drivers.
+  BTS7960_Result result = BTS7960_OK;
+
+  for (size_t driver = 0; driver < group->count; driver++) {
+    if (!BTS7960_HAL_setEnablePinState(group->hals[driver], false)) {
+      result = BTS7960_HAL_ERROR;
+    }
+  }
+
+  return result;
+}
+#endif
+
 #ifdef BTS7960_ENABLE_FREQUENCY_CONTROL
 BTS7960_Result BTS7960_setOutputFrequency(BTS7960 *const bts, uint32_t const frequency) {
   #ifndef BTS7960_DISABLE_ASSERTS
@@ -214,6 +299,7 @@ BTS7960_Result BTS7960_setOutputFrequency(BTS7960 *const bts, uint32_t const fre
     case BTS7960_HAL_FREQUENCY_OK:       return BTS7960_OK;
     case BTS7960_HAL_FREQUENCY_TOO_LOW:  return BTS7960_ERROR_FREQUENCY_TOO_LOW;
     case BTS7960_HAL_FREQUENCY_TOO_HIGH: return BTS7960_ERROR_FREQUENCY_TOO_HIGH;
+    case BTS7960_HAL_FREQUENCY_ERROR:    return BTS7960_HAL_ERROR;
   }
 
   #ifndef BTS7960_DISABLE_ASSERTS
@@ -239,4 +325,257 @@ BTS7960_Result BTS7960_getOutputFrequency(BTS7960 const *const bts, uint32_t *co
 
   return BTS7960_OK;
 }
+
+/// Measures peak-to-peak current sense voltage over `samples` measurements.
+/// @param[in] bts Pointer to initialized BTS7960 driver instance.
+/// @param[in] samples Amount of measurements.
+/// @param[out] ripple Peak-to-peak voltage, in millivolts.
+/// @retval BTS7960_OK If the ripple was measured.
+/// @retval BTS7960_FAULT_DETECTED If any of the measurements indicates a fault.
+/// @retval BTS7960_HAL_ERROR If any of the measurements failed due to an internal HAL error.
+static BTS7960_Result BTS7960_measureCurrentSenseRipple(BTS7960 const *const bts,
+                                                        uint16_t const       samples,
+                                                        uint32_t *const      ripple) {
+  uint32_t min_voltage = UINT32_MAX;
+  uint32_t max_voltage = 0;
+
+  for (uint16_t sample = 0; sample < samples; sample++) {
+    uint32_t voltage = 0;
+
+    if (!BTS7960_HAL_measureCurrentSenseVoltage(bts->hal, &voltage)) {
+      return BTS7960_HAL_ERROR;
+    }
+
+    if (voltage >= bts->fault_voltage_min) {
+      return BTS7960_FAULT_DETECTED;
+    }
+
+    if (voltage < min_voltage) {
+      min_voltage = voltage;
+    }
+
+    if (voltage > max_voltage) {
+      max_voltage = voltage;
+    }
+  }
+
+  *ripple = max_voltage - min_voltage;
+  return BTS7960_OK;
+}
+
+BTS7960_Result BTS7960_tuneOutputFrequency(BTS7960 *const                      bts,
+                                           BTS7960_FrequencySweep const *const sweep,
+                                           BTS7960_FrequencySweepResult *const result) {
+  #ifndef BTS7960_DISABLE_ASSERTS
+  assert(bts);
+  assert(sweep);
+  assert(result);
+  assert(sweep->frequency_step);
+  // Peak-to-peak ripple of a single sample is always 0, so every frequency would look equally good.
+  assert(sweep->samples_per_step >= 2);
+  assert(sweep->min_frequency <= sweep->max_frequency);
+  #endif
+
+  result->frequency = 0;
+  result->ripple    = 0;
+
+  if (!bts->is_initialized) {
+    return BTS7960_NOT_INITIALIZED;
+  }
+
+  if (sweep->percentage > 100) {
+    return BTS7960_ERROR_INVALID_POWER_VALUE;
+  }
+
+  uint32_t previous_frequency  = 0;
+  uint8_t  previous_percentage = 0;
+
+  if (!BTS7960_HAL_getPwmSignalFrequency(bts->hal, &previous_frequency)
+      || !BTS7960_HAL_getPwmSignalPercentage(bts->hal, &previous_percentage)
+      || !BTS7960_HAL_setPwmSignalPercentage(bts->hal, sweep->percentage))
+  {
+    return BTS7960_HAL_ERROR;
+  }
+
+  // Frequency is computed from step index, as `frequency + frequency_step` could overflow past `max_frequency`.
+  // Step index is 64-bit, so the loop also terminates when `last_step` is UINT32_MAX (full range with 1Hz step).
+  uint32_t const last_step      = (sweep->max_frequency - sweep->min_frequency) / sweep->frequency_step;
+  BTS7960_Result sweep_result   = BTS7960_ERROR_FREQUENCY_TOO_LOW;
+  uint32_t       best_frequency = 0;
+  uint32_t       best_ripple    = UINT32_MAX;
+
+  for (uint64_t step = 0; step <= last_step; step++) {
+    uint32_t const frequency = sweep->min_frequency + ((uint32_t)step) * sweep->frequency_step;
+
+    BTS7960_HAL_FrequencyStatus const frequency_status = BTS7960_HAL_setPwmSignalFrequency(bts->hal, frequency);
+
+    if (frequency_status == BTS7960_HAL_FREQUENCY_ERROR) {
+      sweep_result = BTS7960_HAL_ERROR;
+      break;
+    }
+
+    if (frequency_status == BTS7960_HAL_FREQUENCY_TOO_LOW) {
+      continue;
+    }
+
+    if (frequency_status == BTS7960_HAL_FREQUENCY_TOO_HIGH) {
+      // Every following frequency will also be too high.
+      if (sweep_result == BTS7960_ERROR_FREQUENCY_TOO_LOW) {
+        sweep_result = BTS7960_ERROR_FREQUENCY_TOO_HIGH;
+      }
+      break;
+    }
+
+    uint32_t             ripple        = 0;
+    BTS7960_Result const ripple_result = BTS7960_measureCurrentSenseRipple(bts, sweep->samples_per_step, &ripple);
+
+    if (ripple_result != BTS7960_OK) {
+      sweep_result = ripple_result;
+      break;
+    }
+
+    // Strict comparison prefers lower frequency on ties.
+    if (ripple < best_ripple) {
+      best_ripple    = ripple;
+      best_frequency = frequency;
+    }
+
+    sweep_result = BTS7960_OK;
+  }
+
+  uint32_t const final_frequency = (sweep_result == BTS7960_OK) ? best_frequency : previous_frequency;
+
+  // Duty cycle goes first, as lowering the drive is more important than the frequency. Both are always set, because
+  // frequency can't be restored after the sweep failed with BTS7960_HAL_FREQUENCY_ERROR.
+  bool is_restored = BTS7960_HAL_setPwmSignalPercentage(bts->hal, previous_percentage);
+
+  if (BTS7960_HAL_setPwmSignalFrequency(bts->hal, final_frequency) != BTS7960_HAL_FREQUENCY_OK) {
+    is_restored = false;
+  }
+
+  if (!is_restored) {
+    return BTS7960_HAL_ERROR;
+  }
+
+  if (sweep_result == BTS7960_OK) {
+    result->frequency = best_frequency;
+    // Only the picked ripple is converted to current, see BTS7960_getStatus for details.
+    result->ripple    = bts->current_sense_multiplier * best_ripple;
+  }
+
+  return sweep_result;
+}
+#endif
+
+#ifdef BTS7960_ENABLE_EVENTS
+/// Reports the event via user handler, if it's set.
+/// @param[in] bts Pointer to initialized BTS7960 driver instance.
+/// @param[in] event Reported event.
+static inline void BTS7960_reportEvent(BTS7960 *const bts, BTS7960_Event const event) {
+  // Handler pointer is read once, so the callback and context always come from the same handler.
+  BTS7960_EventHandler const *const handler = bts->event_handler;
+
+  if (handler && handler->callback) {
+    handler->callback(bts, event, handler->context);
+  }
+}
+
+BTS7960_Result BTS7960_setEventHandler(BTS7960 *const bts, BTS7960_EventHandler const *const handler) {
+  #ifndef BTS7960_DISABLE_ASSERTS
+  assert(bts);
+  #endif
+
+  if (!bts->is_initialized) {
+    return BTS7960_NOT_INITIALIZED;
+  }
+
+  bts->event_handler = handler;
+  return BTS7960_OK;
+}
+
+BTS7960_Result BTS7960_setCurrentThreshold(BTS7960 *const bts, uint32_t const current) {
+  #ifndef BTS7960_DISABLE_ASSERTS
+  assert(bts);
+  #endif
+
+  if (!bts->is_initialized) {
+    return BTS7960_NOT_INITIALIZED;
+  }
+
+  uint32_t const multiplier = bts->current_sense_multiplier;
+
+  if (!multiplier) {
+    return BTS7960_INTERNAL_ERROR;
+  }
+
+  // `Il = multiplier * Vis` (see BTS7960_getStatus), so the current reaches the threshold when the voltage reaches
+  // `threshold / multiplier`, rounded up. Non-zero current always gives non-zero voltage, which keeps 0 as "disabled".
+  uint32_t const voltage = current / multiplier + (current % multiplier != 0);
+
+  // Voltages above the mask are out of ADC range anyway, so clamping doesn't change the behavior.
+  // Single store also clears the threshold state.
+  bts->current_threshold = (voltage > BTS7960_CURRENT_THRESHOLD_VOLTAGE_MASK) ? BTS7960_CURRENT_THRESHOLD_VOLTAGE_MASK
+                                                                              : voltage;
+  return BTS7960_OK;
+}
+
+BTS7960_Result BTS7960_processCurrentSenseVoltage(BTS7960 *const bts, uint32_t const voltage) {
+  #ifndef BTS7960_DISABLE_ASSERTS
+  assert(bts);
+  #endif
+
+  if (!bts->is_initialized) {
+    return BTS7960_NOT_INITIALIZED;
+  }
+
+  bool const is_fault = voltage >= bts->fault_voltage_min;
+
+  if (is_fault != bts->is_fault_active) {
+    bts->is_fault_active = is_fault;
+    BTS7960_reportEvent(bts, is_fault ? BTS7960_EVENT_FAULT_ENTERED : BTS7960_EVENT_FAULT_CLEARED);
+  }
+
+  // Current sense voltage doesn't represent the current in fault mode, so threshold state is kept as it was.
+  if (is_fault) {
+    return BTS7960_FAULT_DETECTED;
+  }
+
+  // Threshold is read once, so the voltage and state always come from the same BTS7960_setCurrentThreshold() call.
+  uint32_t const current_threshold = bts->current_threshold;
+  uint32_t const threshold_voltage = current_threshold & BTS7960_CURRENT_THRESHOLD_VOLTAGE_MASK;
+
+  if (threshold_voltage) {
+    bool const is_above_threshold  = voltage >= threshold_voltage;
+    bool const was_above_threshold = (current_threshold & BTS7960_CURRENT_THRESHOLD_ABOVE_FLAG) != 0;
+
+    if (is_above_threshold != was_above_threshold) {
+      // Read-modify-write, see BTS7960_setCurrentThreshold for the contexts it can be called from.
+      bts->current_threshold = threshold_voltage | (is_above_threshold ? BTS7960_CURRENT_THRESHOLD_ABOVE_FLAG : 0);
+      BTS7960_reportEvent(bts,
+                          is_above_threshold ? BTS7960_EVENT_CURRENT_ABOVE_THRESHOLD
+                                             : BTS7960_EVENT_CURRENT_BELOW_THRESHOLD);
+    }
+  }
+
+  return BTS7960_OK;
+}
+
+BTS7960_Result BTS7960_sampleCurrentSense(BTS7960 *const bts) {
+  #ifndef BTS7960_DISABLE_ASSERTS
+  assert(bts);
+  #endif
+
+  if (!bts->is_initialized) {
+    return BTS7960_NOT_INITIALIZED;
+  }
+
+  uint32_t voltage = 0;
+
+  if (!BTS7960_HAL_measureCurrentSenseVoltage(bts->hal, &voltage)) {
+    BTS7960_reportEvent(bts, BTS7960_EVENT_HAL_ERROR);
+    return BTS7960_HAL_ERROR;
+  }
+
+  return BTS7960_processCurrentSenseVoltage(bts, voltage);
+}
 #endif
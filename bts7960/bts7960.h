@@ -9,13 +9,25 @@
 ///   - Initializing and de-initializing the hardware required for BTS7960 to operate;
 ///   - Enabling and disabling BTS7960 via hardware enable pin;
 ///   - Setting the PWM signal modulation parameters (frequency and duty cycle);
+///   - Picking the PWM frequency with the lowest current ripple by sweeping the allowed frequency range;
 ///   - Checking the status of BTS7960 by monitoring the status pin;
+///   - Notifying about faults and current threshold crossings via callback, instead of polling the status;
+///   - Disabling a group of drivers at once (emergency stop);
 ///
 /// Some of the features may not be present on all platforms, depending on HAL implementation. Configuration of this
 /// driver's capabilities can be performed via macros:
 ///   * BTS7960_DISABLE_ASSERTS - when defined, disables asserts in library's code, along with `assert.h` library.
 ///   * BTS7960_ENABLE_FREQUENCY_CONTROL - when defined, enables frequency control functions. Define it if your HAL
 ///   supports it.
+///   * BTS7960_ENABLE_EVENTS - when defined, enables event callback API. Define it if you want to be notified about
+///   faults and current threshold crossings from current sense sampling path (for example, ADC interrupt).
+///   * BTS7960_ENABLE_EMERGENCY_STOP - when defined, enables driver groups and emergency stop functions. Define it if
+///   you need to disable multiple drivers at once.
+///   * BTS7960_ENABLE_BATCHED_HAL - when defined, emergency stop disables the whole group with a single HAL
+///   operation. Define it if your HAL can set multiple `enable` pins at once. Requires BTS7960_ENABLE_EMERGENCY_STOP.
+///   * BTS7960_DISABLE_CONFIGURATION_STORAGE - when defined, `BTS7960` instance keeps only the values used by the
+///   driver after initialization, dropping the configuration passed to `BTS7960_advancedInitialize` and the values
+///   derived from it. Define it to save RAM when running many instances on small MCUs.
 ///
 /// @important In order to use this library, you must provide your own HAL bindings for the target platform. HAL is the
 /// library's back-end, providing control over the actual hardware of the MCU. See `bts7960_hal.h` file for details.
@@ -31,34 +43,115 @@
 
 #include <inttypes.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
+#if defined(BTS7960_ENABLE_BATCHED_HAL) && !defined(BTS7960_ENABLE_EMERGENCY_STOP)
+  #error "BTS7960_ENABLE_BATCHED_HAL requires BTS7960_ENABLE_EMERGENCY_STOP"
+#endif
+
 #ifdef __cplusplus
 extern "C"
 {
 #endif
 
+#ifdef BTS7960_ENABLE_EVENTS
+  /// Events reported via BTS7960_EventCallback.
+  /// Fault and threshold events are reported only on edges, so each of them is reported once per state change.
+  typedef enum BTS7960_Event_t {
+    BTS7960_EVENT_FAULT_ENTERED,            ///< Current sense voltage reached the fault voltage.
+    BTS7960_EVENT_FAULT_CLEARED,            ///< Current sense voltage dropped below the fault voltage.
+    BTS7960_EVENT_CURRENT_ABOVE_THRESHOLD,  ///< Current reached the threshold set by BTS7960_setCurrentThreshold().
+    BTS7960_EVENT_CURRENT_BELOW_THRESHOLD,  ///< Current dropped below the threshold.
+    BTS7960_EVENT_HAL_ERROR,                ///< Current sense voltage measurement failed due to an internal HAL error.
+  } BTS7960_Event;
+
+  struct BTS7960_t;
+
+  /// Event callback, called from the context of the function that processed the sample.
+  /// @param[in] bts Pointer to BTS7960 driver instance that reported the event.
+  /// @param[in] event Reported event.
+  /// @param[in] context User context from BTS7960_EventHandler.
+  typedef void (*BTS7960_EventCallback)(struct BTS7960_t *bts, BTS7960_Event event, void *context);
+
+  /// Event callback with its user context, registered with BTS7960_setEventHandler().
+  /// Driver keeps only the pointer to the handler, so callback and context are always swapped together.
+  typedef struct BTS7960_EventHandler_t {
+    BTS7960_EventCallback callback;  ///< Event callback.
+    void                 *context;   ///< User context passed to the callback.
+  } BTS7960_EventHandler;
+
+  /// Bit of BTS7960::current_threshold set while the current is above the threshold.
+  static uint32_t const BTS7960_CURRENT_THRESHOLD_ABOVE_FLAG = UINT32_C(1) << 31;
+
+  /// Bits of BTS7960::current_threshold holding the threshold as current sense voltage.
+  static uint32_t const BTS7960_CURRENT_THRESHOLD_VOLTAGE_MASK = UINT32_C(0x7FFFFFFF);
+#endif
+
   /// BTS7960 instance.
   /// Voltages are in millivolts, unless stated otherwise.
+  /// Fields used by the driver after initialization go first, configuration fields can be compiled out with
+  /// BTS7960_DISABLE_CONFIGURATION_STORAGE.
   typedef struct BTS7960_t {
     BTS7960_HAL *hal;                       ///< Pointer to a HAL instance.
-    uint32_t     current_sense_resistance;  ///< Current sense resistance, in ohms.
-    uint32_t     fault_voltage;             ///< Voltage on current sense pin when driver is in fault mode.
-    uint32_t     fault_voltage_epsilon;     ///< Fault voltage absolute tolerance.
     uint32_t     fault_voltage_min;         ///< Minimum voltage on status pin to be considered as a fault.
     uint32_t     current_sense_multiplier;  ///< Current sense multiplier for measured voltage.
-    uint16_t     current_sense_ratio;       ///< Current sense ratio.
-    uint16_t     current_in_fault_mode;     ///< Current in fault mode, in microampere.
-    uint8_t      fault_voltage_tolerance;   ///< Fault voltage relative tolerance (in percent).
-    bool         is_initialized;            ///< Flag set by `Initialize` to indicate readiness.
+#ifdef BTS7960_ENABLE_EVENTS
+    BTS7960_EventHandler const *event_handler;  ///< Event handler, NULL if not set.
+    /// Current threshold as current sense voltage (0 if disabled) and threshold state from the last processed sample,
+    /// see BTS7960_CURRENT_THRESHOLD_VOLTAGE_MASK and BTS7960_CURRENT_THRESHOLD_ABOVE_FLAG. Both are kept in a single
+    /// word, so the sampling path never sees a new threshold with the state of the old one.
+    uint32_t current_threshold;
+#endif
+#ifndef BTS7960_DISABLE_CONFIGURATION_STORAGE
+    uint32_t current_sense_resistance;      ///< Current sense resistance, in ohms.
+    uint32_t fault_voltage;                 ///< Voltage on current sense pin when driver is in fault mode.
+    uint32_t fault_voltage_epsilon;         ///< Fault voltage absolute tolerance.
+    uint16_t current_sense_ratio;           ///< Current sense ratio.
+    uint16_t current_in_fault_mode;         ///< Current in fault mode, in microampere.
+    uint8_t  fault_voltage_tolerance;       ///< Fault voltage relative tolerance (in percent).
+#endif
+    bool is_initialized;                    ///< Flag set by `Initialize` to indicate readiness.
+#ifdef BTS7960_ENABLE_EVENTS
+    bool is_fault_active;                   ///< Fault state from the last processed sample.
+#endif
   } BTS7960;
 
+#ifdef BTS7960_ENABLE_EMERGENCY_STOP
+  /// Group of BTS7960 drivers that are disabled together by BTS7960_emergencyStop().
+  /// All fields are filled by BTS7960_initializeGroup(), so emergency stop doesn't have to access driver instances.
+  typedef struct BTS7960_Group_t {
+    BTS7960_HAL **hals;                       ///< HAL instances of group's drivers, in the order of disabling.
+    size_t        count;                      ///< Amount of drivers in the group.
+    size_t        worst_case_hal_operations;  ///< Upper bound of HAL operations performed by emergency stop.
+    bool          is_batched;                 ///< If true, all drivers are disabled with a single HAL operation.
+  } BTS7960_Group;
+#endif
+
   /// BTS7960 state, returned by BTS7960_checkState() function.
   typedef struct BTS7960_State_t {
     uint32_t current;  ///< Current flowing through the driver, in milliamperes.
     bool     fault;    ///< If true, the driver is currently in fault mode.
   } BTS7960_Status;
 
+#ifdef BTS7960_ENABLE_FREQUENCY_CONTROL
+  /// PWM frequency sweep parameters, used by BTS7960_tuneOutputFrequency() function.
+  /// Frequencies are in hertz.
+  typedef struct BTS7960_FrequencySweep_t {
+    uint32_t min_frequency;     ///< First frequency to check.
+    uint32_t max_frequency;     ///< Last frequency to check, must not be lower than `min_frequency`.
+    uint32_t frequency_step;    ///< Frequency increment between consecutive checks, must be non-zero.
+    uint16_t samples_per_step;  ///< Amount of current sense measurements for each frequency, must be at least 2.
+    uint8_t  percentage;        ///< PWM duty cycle used during the sweep, in 0-100 range.
+  } BTS7960_FrequencySweep;
+
+  /// PWM frequency sweep result, returned by BTS7960_tuneOutputFrequency() function.
+  typedef struct BTS7960_FrequencySweepResult_t {
+    uint32_t frequency;  ///< Frequency with the lowest current ripple, in hertz.
+    uint32_t ripple;     ///< Peak-to-peak current ripple at `frequency`, in milliamperes.
+  } BTS7960_FrequencySweepResult;
+#endif
+
   /// Enumeration representing a result of performed operation.
   typedef enum BTS7960_Result_t {
     BTS7960_OK,                         ///< Operation was successful.
@@ -182,6 +275,35 @@ extern "C"
   /// @retval BTS7960_HAL_ERROR If getting the power failed due to an internal HAL error.
   BTS7960_Result BTS7960_getPowerPercentage(BTS7960 const *const bts, uint8_t *const percentage);
 
+#ifdef BTS7960_ENABLE_EMERGENCY_STOP
+  /// Initializes the group of drivers for BTS7960_emergencyStop().
+  /// HAL instances of the drivers are stored in user-provided `hals` array, which must outlive the group.
+  /// With BTS7960_ENABLE_BATCHED_HAL, the group is batched if all drivers use the same HAL implementation that
+  /// supports batched `enable` pin control (with link-time HAL binding, that's always the case).
+  /// @param[out] group Pointer to group instance.
+  /// @param[in] drivers Initialized BTS7960 driver instances.
+  /// @param[out] hals Storage for `count` HAL instance pointers.
+  /// @param[in] count Amount of drivers, must be non-zero.
+  /// @retval BTS7960_OK If the group was initialized.
+  /// @retval BTS7690_NOT_INITIALIZED If any of the drivers is not initialized.
+  BTS7960_Result BTS7960_initializeGroup(BTS7960_Group *const  group,
+                                         BTS7960 *const *const drivers,
+                                         BTS7960_HAL **const   hals,
+                                         size_t const          count);
+
+  /// Disables all drivers in the group as fast as possible.
+  /// Batched groups are disabled with a single HAL operation, and if it fails, every driver is disabled one by one
+  /// as a fallback. Other groups are disabled one by one, directly via HAL. Failure of a single driver doesn't stop
+  /// the others from being disabled. In any case, no more than `group->worst_case_hal_operations` HAL operations are
+  /// performed.
+  /// This function doesn't modify any driver or group state, so it can be called from interrupt context (for example,
+  /// from BTS7960_EVENT_FAULT_ENTERED event callback), as long as HAL `enable` pin functions can.
+  /// @param[in] group Pointer to initialized group instance.
+  /// @retval BTS7960_OK If all drivers were disabled.
+  /// @retval BTS7960_HAL_ERROR If any of the drivers couldn't be disabled due to an internal HAL error.
+  BTS7960_Result BTS7960_emergencyStop(BTS7960_Group const *const group);
+#endif
+
 #ifdef BTS7960_ENABLE_FREQUENCY_CONTROL
   /// Sets the output signal frequency.
   /// @param[in] bts Pointer to BTS7960 driver instance.
@@ -201,6 +323,81 @@ extern "C"
   /// @retval BTS7690_NOT_INITIALIZED If driver is not initialized.
   /// @retval BTS7960_HAL_ERROR If getting the frequency failed due to an internal HAL error.
   BTS7960_Result BTS7960_getOutputFrequency(BTS7960 const *const bts, uint32_t *const frequency);
+
+  /// Sweeps the output signal frequency and sets the one with the lowest current ripple for given duty cycle.
+  /// Frequencies rejected by HAL as too low are skipped, and the sweep ends at the first frequency rejected as too
+  /// high, so the range can be wider than the one supported by the hardware. HAL failure to set the frequency
+  /// (BTS7960_HAL_FREQUENCY_ERROR) ends the sweep with BTS7960_HAL_ERROR. Ripple is measured as peak-to-peak
+  /// current sense voltage over `samples_per_step` measurements. Statistics are accumulated while sampling, so every
+  /// measurement is read only once and the sweep takes at most
+  /// `((max_frequency - min_frequency) / frequency_step + 1) * samples_per_step` measurements.
+  /// If multiple frequencies have the same ripple, the lowest one is picked to minimize switching losses.
+  /// The driver should be enabled, with the load connected, before calling this function.
+  /// Duty cycle is restored after the sweep. On error, the frequency is restored too and the result is set to 0.
+  /// @param[in] bts Pointer to BTS7960 driver instance.
+  /// @param[in] sweep Sweep parameters.
+  /// @param[out] result Picked frequency and its current ripple.
+  /// @retval BTS7960_OK If the frequency was picked and set successfully.
+  /// @retval BTS7690_NOT_INITIALIZED If driver is not initialized.
+  /// @retval BTS7960_ERROR_INVALID_POWER_VALUE If `sweep->percentage` is outside of [0, 100] range.
+  /// @retval BTS7960_ERROR_FREQUENCY_TOO_LOW If all frequencies in the range are too low.
+  /// @retval BTS7960_ERROR_FREQUENCY_TOO_HIGH If all frequencies in the range are too high.
+  /// @retval BTS7960_FAULT_DETECTED If a driver's fault is detected during the sweep.
+  /// @retval BTS7960_HAL_ERROR If the sweep failed due to an internal HAL error.
+  BTS7960_Result BTS7960_tuneOutputFrequency(BTS7960 *const                      bts,
+                                             BTS7960_FrequencySweep const *const sweep,
+                                             BTS7960_FrequencySweepResult *const result);
+#endif
+
+#ifdef BTS7960_ENABLE_EVENTS
+  /// Sets the event handler, replacing the previous one.
+  /// Handler is registered with a single pointer store, and the sampling path reads the pointer once per event, so the
+  /// handler can be replaced while samples are processed, as long as pointer stores are atomic on the target (true for
+  /// aligned pointers on common MCUs). Otherwise, mask the sampling interrupt while calling this function.
+  /// @important Callback is called from the context of BTS7960_processCurrentSenseVoltage() and
+  ///            BTS7960_sampleCurrentSense(), which may be an interrupt. Keep it short.
+  /// @important Handler must stay valid until it's replaced, as the driver doesn't copy it. Handler's fields must not
+  ///            be modified while it's registered.
+  /// @param[in] bts Pointer to BTS7960 driver instance.
+  /// @param[in] handler Event handler, NULL disables the events.
+  /// @retval BTS7960_OK If the handler was set.
+  /// @retval BTS7690_NOT_INITIALIZED If driver is not initialized.
+  BTS7960_Result BTS7960_setEventHandler(BTS7960 *const bts, BTS7960_EventHandler const *const handler);
+
+  /// Sets the current threshold for BTS7960_EVENT_CURRENT_ABOVE_THRESHOLD and BTS7960_EVENT_CURRENT_BELOW_THRESHOLD
+  /// events. The threshold is converted to current sense voltage once, so samples are compared without any current
+  /// calculations. Threshold state is reset, so if the current is above new threshold, the next sample reports it.
+  /// @important Sampling path writes the threshold state back to the same word as the threshold, so it would overwrite
+  ///            a threshold set in the middle of processing a sample. Call this function only from a context that
+  ///            can't preempt the sampling path nor run concurrently with it (for example, the main loop of a
+  ///            single-core MCU sampling in an interrupt, with 32-bit stores being atomic). Otherwise, mask the
+  ///            sampling interrupt or hold the lock used by the sampling path while calling it.
+  /// @param[in] bts Pointer to BTS7960 driver instance.
+  /// @param[in] current Current threshold in milliamperes, 0 disables threshold events.
+  /// @retval BTS7960_OK If the threshold was set.
+  /// @retval BTS7690_NOT_INITIALIZED If driver is not initialized.
+  /// @retval BTS7960_INTERNAL_ERROR If current sense multiplier is 0, because current sense resistance and ratio
+  ///                                passed to BTS7960_advancedInitialize() are too low.
+  BTS7960_Result BTS7960_setCurrentThreshold(BTS7960 *const bts, uint32_t const current);
+
+  /// Processes a current sense voltage sample and reports the events triggered by it.
+  /// This function is meant to be called from HAL's sampling path (for example, ADC conversion complete interrupt)
+  /// with already measured voltage. Threshold events are not reported while the driver is in fault mode.
+  /// @param[in] bts Pointer to BTS7960 driver instance.
+  /// @param[in] voltage Voltage on the current sense pin, in millivolts.
+  /// @retval BTS7960_OK If the sample was processed.
+  /// @retval BTS7960_FAULT_DETECTED If the sample indicates a driver's fault.
+  /// @retval BTS7690_NOT_INITIALIZED If driver is not initialized.
+  BTS7960_Result BTS7960_processCurrentSenseVoltage(BTS7960 *const bts, uint32_t const voltage);
+
+  /// Measures the current sense voltage via HAL and processes it with BTS7960_processCurrentSenseVoltage().
+  /// Measurement failure is reported with BTS7960_EVENT_HAL_ERROR event.
+  /// @param[in] bts Pointer to BTS7960 driver instance.
+  /// @retval BTS7960_OK If the sample was processed.
+  /// @retval BTS7960_FAULT_DETECTED If the sample indicates a driver's fault.
+  /// @retval BTS7690_NOT_INITIALIZED If driver is not initialized.
+  /// @retval BTS7960_HAL_ERROR If measurement failed due to an internal HAL error.
+  BTS7960_Result BTS7960_sampleCurrentSense(BTS7960 *const bts);
 #endif
 
 #ifdef __cplusplus
@@ -10,13 +10,23 @@
 /// handling or debugging.
 ///
 /// HAL implementation may provide additional functions, for example PWM frequency control,
-/// if available on target platform.
+/// if available on target platform. When BTS7960_ENABLE_BATCHED_HAL macro is defined, HAL must also be able to set
+/// `enable` pins of multiple HAL instances in a single operation (for example, a single GPIO port write), which is
+/// used by BTS7960_emergencyStop().
+///
+/// By default, HAL is bound at link time - the implementation defines `struct BTS7960_HAL_impl` and `BTS7960_HAL_*`
+/// functions, so only one HAL implementation can be linked into a binary. When BTS7960_ENABLE_RUNTIME_HAL macro is
+/// defined, `BTS7960_HAL` is a structure with a pointer to HAL operations table (BTS7960_HAL_Ops) instead, and
+/// `BTS7960_HAL_*` functions dispatch the calls through it. HAL implementations embed `BTS7960_HAL` as the first member
+/// of their own structure and provide their operations table, so multiple implementations can be used by different
+/// driver instances in the same binary, at the cost of an indirect call per HAL operation.
 ///
 /// @important **HAL instance must be initialized manually by the user before using BTS7960 driver!**
 /// @note When using high-frequency PWM as input: BTS7960 input signal frequency limit depends on the selected slew
 ///       resistor value, see the datasheet section `4.2.2 Switching Times` for more details.
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -32,9 +42,37 @@ extern "C"
     BTS7960_HAL_FREQUENCY_OK,
     BTS7960_HAL_FREQUENCY_TOO_LOW,
     BTS7960_HAL_FREQUENCY_TOO_HIGH,
+    BTS7960_HAL_FREQUENCY_ERROR,
   } BTS7960_HAL_FrequencyStatus;
 #endif
 
+#ifdef BTS7960_ENABLE_RUNTIME_HAL
+  /// HAL operations table, see the link-time `BTS7960_HAL_*` function declarations below for their contracts.
+  typedef struct BTS7960_HAL_Ops_t {
+    bool (*initializeHardware)(BTS7960_HAL *const hal);
+    bool (*deInitializeHardware)(BTS7960_HAL *const hal);
+    bool (*setEnablePinState)(BTS7960_HAL *const hal, bool const state);
+    bool (*getEnablePinState)(BTS7960_HAL *const hal, bool *const state);
+    bool (*measureCurrentSenseVoltage)(BTS7960_HAL *const hal, uint32_t *const voltage);
+    bool (*setPwmSignalPercentage)(BTS7960_HAL *const hal, uint8_t const percentage);
+    bool (*getPwmSignalPercentage)(BTS7960_HAL *const hal, uint8_t *const percentage);
+  #ifdef BTS7960_ENABLE_FREQUENCY_CONTROL
+    BTS7960_HAL_FrequencyStatus (*setPwmSignalFrequency)(BTS7960_HAL *const hal, uint32_t const frequency);
+    bool (*getPwmSignalFrequency)(BTS7960_HAL *const hal, uint32_t *const frequency);
+  #endif
+  #ifdef BTS7960_ENABLE_BATCHED_HAL
+    /// Optional, NULL if the implementation doesn't support batched `enable` pin control.
+    bool (*setEnablePinStates)(BTS7960_HAL *const *const hals, size_t const count, bool const state);
+  #endif
+  } BTS7960_HAL_Ops;
+
+  /// Runtime-bound HAL instance, must be the first member of HAL implementation's structure.
+  struct BTS7960_HAL_impl {
+    BTS7960_HAL_Ops const *ops;  ///< HAL operations table of the implementation.
+  };
+#endif
+
+#ifndef BTS7960_ENABLE_RUNTIME_HAL
   /// Initializes the hardware required for BTS7960 to operate.
   /// @param[in] hal Initialized BTS7960 HAL instance.
   /// @retval true The hardware was configured successfully.
@@ -82,13 +120,14 @@ extern "C"
   /// @retval false Couldn't fetch the PWM signal duty cycle.
   bool BTS7960_HAL_getPwmSignalPercentage(BTS7960_HAL *const hal, uint8_t *const percentage);
 
-#ifdef BTS7960_ENABLE_FREQUENCY_CONTROL
+  #ifdef BTS7960_ENABLE_FREQUENCY_CONTROL
   /// Sets the PWM signal frequency.
   /// @param[in] hal Initialized BTS7960 HAL instance.
   /// @param[in] frequency Frequency of the PWM signal.
   /// @retval BTS7960_HAL_FREQUENCY_OK PWM signal frequency has been set.
   /// @retval BTS7960_HAL_FREQUENCY_TOO_LOW Requested PWM signal frequency is too low.
   /// @retval BTS7960_HAL_FREQUENCY_TOO_HIGH Requested PWM signal frequency is too high.
+  /// @retval BTS7960_HAL_FREQUENCY_ERROR Couldn't set the PWM signal frequency due to a hardware error.
   BTS7960_HAL_FrequencyStatus BTS7960_HAL_setPwmSignalFrequency(BTS7960_HAL *const hal, uint32_t const frequency);
 
   /// Gets the PWM signal frequency.
@@ -97,6 +136,68 @@ extern "C"
   /// @retval true PWM signal frequency has been fetched.
   /// @retval false Couldn't fetch the PWM signal frequency.
   bool BTS7960_HAL_getPwmSignalFrequency(BTS7960_HAL *const hal, uint32_t *const frequency);
+  #endif
+
+  #ifdef BTS7960_ENABLE_BATCHED_HAL
+  /// Sets `enable` pin state of multiple HAL instances in a single operation.
+  /// Implementation should try to set the state of every instance, even if some of them fail.
+  /// @param[in] hals Initialized BTS7960 HAL instances.
+  /// @param[in] count Amount of HAL instances.
+  /// @param[in] state State of the pins.
+  /// @retval true The state of all pins has been set.
+  /// @retval false The state of at least one pin couldn't be set.
+  bool BTS7960_HAL_setEnablePinStates(BTS7960_HAL *const *const hals, size_t const count, bool const state);
+  #endif
+#else
+  // Runtime-bound HAL, calls are dispatched through the operations table of HAL instance.
+
+  static inline bool BTS7960_HAL_initializeHardware(BTS7960_HAL *const hal) {
+    return hal->ops->initializeHardware(hal);
+  }
+
+  static inline bool BTS7960_HAL_deInitializeHardware(BTS7960_HAL *const hal) {
+    return hal->ops->deInitializeHardware(hal);
+  }
+
+  static inline bool BTS7960_HAL_setEnablePinState(BTS7960_HAL *const hal, bool const state) {
+    return hal->ops->setEnablePinState(hal, state);
+  }
+
+  static inline bool BTS7960_HAL_getEnablePinState(BTS7960_HAL *const hal, bool *const state) {
+    return hal->ops->getEnablePinState(hal, state);
+  }
+
+  static inline bool BTS7960_HAL_measureCurrentSenseVoltage(BTS7960_HAL *const hal, uint32_t *const voltage) {
+    return hal->ops->measureCurrentSenseVoltage(hal, voltage);
+  }
+
+  static inline bool BTS7960_HAL_setPwmSignalPercentage(BTS7960_HAL *const hal, uint8_t const percentage) {
+    return hal->ops->setPwmSignalPercentage(hal, percentage);
+  }
+
+  static inline bool BTS7960_HAL_getPwmSignalPercentage(BTS7960_HAL *const hal, uint8_t *const percentage) {
+    return hal->ops->getPwmSignalPercentage(hal, percentage);
+  }
+
+  #ifdef BTS7960_ENABLE_FREQUENCY_CONTROL
+  static inline BTS7960_HAL_FrequencyStatus BTS7960_HAL_setPwmSignalFrequency(BTS7960_HAL *const hal,
+                                                                              uint32_t const     frequency) {
+    return hal->ops->setPwmSignalFrequency(hal, frequency);
+  }
+
+  static inline bool BTS7960_HAL_getPwmSignalFrequency(BTS7960_HAL *const hal, uint32_t *const frequency) {
+    return hal->ops->getPwmSignalFrequency(hal, frequency);
+  }
+  #endif
+
+  #ifdef BTS7960_ENABLE_BATCHED_HAL
+  /// All instances must share the operations table with non-NULL `setEnablePinStates`.
+  static inline bool BTS7960_HAL_setEnablePinStates(BTS7960_HAL *const *const hals,
+                                                    size_t const              count,
+                                                    bool const                state) {
+    return hals[0]->ops->setEnablePinStates(hals, count, state);
+  }
+  #endif
 #endif
 
 #ifdef __cplusplus
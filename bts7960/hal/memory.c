@@ -0,0 +1,84 @@
+/// @file memory.c
+/// In-memory BTS7960 HAL, keeping the hardware state in its structure.
+
+#include "memory.h"
+
+/// Counts the HAL operation and returns the memory HAL owning HAL instance.
+static BTS7960_HAL_Memory *BTS7960_HAL_Memory_beginOperation(BTS7960_HAL *const hal) {
+  BTS7960_HAL_Memory *const memory = (BTS7960_HAL_Memory *)hal;
+  memory->operation_count++;
+  return memory;
+}
+
+static bool BTS7960_HAL_Memory_initializeHardware(BTS7960_HAL *const hal) {
+  BTS7960_HAL_Memory *const memory = BTS7960_HAL_Memory_beginOperation(hal);
+
+  memory->is_initialized        = true;
+  memory->enable_pin_state      = false;
+  memory->current_sense_voltage = 0;
+  memory->pwm_signal_percentage = 0;
+#ifdef BTS7960_ENABLE_FREQUENCY_CONTROL
+  memory->pwm_signal_frequency = 0;
+#endif
+  return true;
+}
+
+static bool BTS7960_HAL_Memory_deInitializeHardware(BTS7960_HAL *const hal) {
+  BTS7960_HAL_Memory *const memory = BTS7960_HAL_Memory_beginOperation(hal);
+
+  memory->is_initialized   = false;
+  memory->enable_pin_state = false;
+  return true;
+}
+
+static bool BTS7960_HAL_Memory_setEnablePinState(BTS7960_HAL *const hal, bool const state) {
+  BTS7960_HAL_Memory_beginOperation(hal)->enable_pin_state = state;
+  return true;
+}
+
+static bool BTS7960_HAL_Memory_getEnablePinState(BTS7960_HAL *const hal, bool *const state) {
+  *state = BTS7960_HAL_Memory_beginOperation(hal)->enable_pin_state;
+  return true;
+}
+
+static bool BTS7960_HAL_Memory_measureCurrentSenseVoltage(BTS7960_HAL *const hal, uint32_t *const voltage) {
+  *voltage = BTS7960_HAL_Memory_beginOperation(hal)->current_sense_voltage;
+  return true;
+}
+
+static bool BTS7960_HAL_Memory_setPwmSignalPercentage(BTS7960_HAL *const hal, uint8_t const percentage) {
+  BTS7960_HAL_Memory_beginOperation(hal)->pwm_signal_percentage = percentage;
+  return true;
+}
+
+static bool BTS7960_HAL_Memory_getPwmSignalPercentage(BTS7960_HAL *const hal, uint8_t *const percentage) {
+  *percentage = BTS7960_HAL_Memory_beginOperation(hal)->pwm_signal_percentage;
+  return true;
+}
+
+#ifdef BTS7960_ENABLE_FREQUENCY_CONTROL
+static BTS7960_HAL_FrequencyStatus BTS7960_HAL_Memory_setPwmSignalFrequency(BTS7960_HAL *const hal,
+                                                                            uint32_t const     frequency) {
+  BTS7960_HAL_Memory_beginOperation(hal)->pwm_signal_frequency = frequency;
+  return BTS7960_HAL_FREQUENCY_OK;
+}
+
+static bool BTS7960_HAL_Memory_getPwmSignalFrequency(BTS7960_HAL *const hal, uint32_t *const frequency) {
+  *frequency = BTS7960_HAL_Memory_beginOperation(hal)->pwm_signal_frequency;
+  return true;
+}
+#endif
+
+BTS7960_HAL_Ops const BTS7960_HAL_MEMORY_OPS = {
+  .initializeHardware         = BTS7960_HAL_Memory_initializeHardware,
+  .deInitializeHardware       = BTS7960_HAL_Memory_deInitializeHardware,
+  .setEnablePinState          = BTS7960_HAL_Memory_setEnablePinState,
+  .getEnablePinState          = BTS7960_HAL_Memory_getEnablePinState,
+  .measureCurrentSenseVoltage = BTS7960_HAL_Memory_measureCurrentSenseVoltage,
+  .setPwmSignalPercentage     = BTS7960_HAL_Memory_setPwmSignalPercentage,
+  .getPwmSignalPercentage     = BTS7960_HAL_Memory_getPwmSignalPercentage,
+#ifdef BTS7960_ENABLE_FREQUENCY_CONTROL
+  .setPwmSignalFrequency = BTS7960_HAL_Memory_setPwmSignalFrequency,
+  .getPwmSignalFrequency = BTS7960_HAL_Memory_getPwmSignalFrequency,
+#endif
+};
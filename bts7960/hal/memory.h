@@ -0,0 +1,40 @@
+/// @file memory.h
+/// In-memory BTS7960 HAL, keeping the hardware state in its structure.
+/// Every operation succeeds and is counted, which makes it useful as a second backend in tests and as a reference
+/// for the cost of HAL dispatch. It doesn't support batched `enable` pin control.
+/// Available only with runtime HAL binding (BTS7960_ENABLE_RUNTIME_HAL, see `bts7960_hal.h`), set `base.ops` to
+/// `&BTS7960_HAL_MEMORY_OPS` before use.
+#pragma once
+
+#include "../bts7960_hal.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef BTS7960_ENABLE_RUNTIME_HAL
+  #error "In-memory HAL requires BTS7960_ENABLE_RUNTIME_HAL"
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  typedef struct BTS7960_HAL_Memory_t {
+    BTS7960_HAL base;  ///< Runtime HAL base, must be the first member.
+    uint32_t    operation_count;
+    bool        is_initialized;
+    bool        enable_pin_state;
+    uint32_t    current_sense_voltage;
+    uint8_t     pwm_signal_percentage;
+#ifdef BTS7960_ENABLE_FREQUENCY_CONTROL
+    uint32_t pwm_signal_frequency;
+#endif
+  } BTS7960_HAL_Memory;
+
+  /// In-memory HAL operations table.
+  extern BTS7960_HAL_Ops const BTS7960_HAL_MEMORY_OPS;
+
+#ifdef __cplusplus
+}
+#endif
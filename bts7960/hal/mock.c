@@ -4,7 +4,27 @@
 
 #include "mock.h"
 
-bool BTS7960_HAL_initializeHardware(BTS7960_HAL *const hal) {
+#ifdef BTS7960_ENABLE_RUNTIME_HAL
+  // Mock functions are reachable only via BTS7960_HAL_MOCK_OPS, as `BTS7960_HAL_*` names are taken by dispatchers.
+  // They're static, like the ones of other backends, so multiple backends can be linked into one binary.
+  #define BTS7960_HAL_MOCK_FUNCTION(type, name) static type BTS7960_HAL_Mock_##name
+#else
+  #define BTS7960_HAL_MOCK_FUNCTION(type, name) type BTS7960_HAL_##name
+#endif
+
+static uint32_t BTS7960_HAL_mock_clock = 0;
+
+/// Advances mock clock and returns the mock owning HAL instance.
+static BTS7960_HAL_Mock *BTS7960_HAL_Mock_beginOperation(BTS7960_HAL *const base) {
+  BTS7960_HAL_mock_clock++;
+  return BTS7960_HAL_Mock_fromHal(base);
+}
+
+uint32_t BTS7960_HAL_Mock_getClock(void) { return BTS7960_HAL_mock_clock; }
+
+BTS7960_HAL_MOCK_FUNCTION(bool, initializeHardware)(BTS7960_HAL *const base) {
+  BTS7960_HAL_Mock *const hal = BTS7960_HAL_Mock_beginOperation(base);
+
   if (hal->should_init_succeed) {
     hal->should_deinit_succeed                        = true;
     hal->should_set_enable_pin_state_succeed          = true;
@@ -17,20 +37,30 @@ bool BTS7960_HAL_initializeHardware(BTS7960_HAL *const hal) {
     hal->max_allowed_frequency                   = BTS7960_HAL_MOCK_DEFAULT_MAX_ALLOWED_FREQUENCY;
     hal->should_set_pwm_signal_frequency_succeed = true;
     hal->should_get_pwm_signal_frequency_succeed = true;
+    hal->current_sense_ripple_model              = NULL;
 #endif
 
-    hal->enable_pin_state      = false;
-    hal->current_sense_voltage = 0;
-    hal->pwm_signal_pecentage  = 0;
+    hal->enable_pin_state                = false;
+    hal->enable_pin_state_timestamp      = 0;
+    hal->current_sense_voltage           = 0;
+    hal->current_sense_measurement_count = 0;
+    hal->pwm_signal_pecentage            = 0;
+
+    hal->current_sense_voltage_stream          = NULL;
+    hal->current_sense_voltage_stream_length   = 0;
+    hal->current_sense_voltage_stream_position = 0;
 #ifdef BTS7960_ENABLE_FREQUENCY_CONTROL
-    hal->pwm_signal_frequency = BTS7960_HAL_MOCK_DEFAULT_MIN_ALLOWED_FREQUENCY;
+    hal->pwm_signal_frequency       = BTS7960_HAL_MOCK_DEFAULT_MIN_ALLOWED_FREQUENCY;
+    hal->current_sense_ripple_phase = false;
 #endif
   }
 
   return hal->should_init_succeed;
 }
 
-bool BTS7960_HAL_deInitializeHardware(BTS7960_HAL *const hal) {
+BTS7960_HAL_MOCK_FUNCTION(bool, deInitializeHardware)(BTS7960_HAL *const base) {
+  BTS7960_HAL_Mock *const hal = BTS7960_HAL_Mock_beginOperation(base);
+
   if (hal->should_deinit_succeed) {
     hal->should_init_succeed                          = true;
     hal->should_set_enable_pin_state_succeed          = false;
@@ -43,28 +73,64 @@ bool BTS7960_HAL_deInitializeHardware(BTS7960_HAL *const hal) {
     hal->max_allowed_frequency                   = 0;
     hal->should_set_pwm_signal_frequency_succeed = false;
     hal->should_get_pwm_signal_frequency_succeed = false;
+    hal->current_sense_ripple_model              = NULL;
 #endif
 
-    hal->enable_pin_state      = false;
-    hal->current_sense_voltage = 0;
-    hal->pwm_signal_pecentage  = 0;
+    hal->enable_pin_state                = false;
+    hal->enable_pin_state_timestamp      = 0;
+    hal->current_sense_voltage           = 0;
+    hal->current_sense_measurement_count = 0;
+    hal->pwm_signal_pecentage            = 0;
+
+    hal->current_sense_voltage_stream          = NULL;
+    hal->current_sense_voltage_stream_length   = 0;
+    hal->current_sense_voltage_stream_position = 0;
 #ifdef BTS7960_ENABLE_FREQUENCY_CONTROL
-    hal->pwm_signal_frequency = 0;
+    hal->pwm_signal_frequency       = 0;
+    hal->current_sense_ripple_phase = false;
 #endif
   }
 
   return hal->should_deinit_succeed;
 }
 
-bool BTS7960_HAL_setEnablePinState(BTS7960_HAL *const hal, bool const state) {
+BTS7960_HAL_MOCK_FUNCTION(bool, setEnablePinState)(BTS7960_HAL *const base, bool const state) {
+  BTS7960_HAL_Mock *const hal = BTS7960_HAL_Mock_beginOperation(base);
+
   if (hal->should_set_enable_pin_state_succeed) {
-    hal->enable_pin_state = state;
+    hal->enable_pin_state           = state;
+    hal->enable_pin_state_timestamp = BTS7960_HAL_mock_clock;
   }
 
   return hal->should_set_enable_pin_state_succeed;
 }
 
-bool BTS7960_HAL_getEnablePinState(BTS7960_HAL *const hal, bool *const state) {
+#ifdef BTS7960_ENABLE_BATCHED_HAL
+BTS7960_HAL_MOCK_FUNCTION(bool, setEnablePinStates)(BTS7960_HAL *const *const bases,
+                                                     size_t const              count,
+                                                     bool const                state) {
+  // Whole batch is a single operation, so all pins share the timestamp.
+  BTS7960_HAL_mock_clock++;
+  bool all_succeeded = true;
+
+  for (size_t index = 0; index < count; index++) {
+    BTS7960_HAL_Mock *const hal = BTS7960_HAL_Mock_fromHal(bases[index]);
+
+    if (hal->should_set_enable_pin_state_succeed) {
+      hal->enable_pin_state           = state;
+      hal->enable_pin_state_timestamp = BTS7960_HAL_mock_clock;
+    } else {
+      all_succeeded = false;
+    }
+  }
+
+  return all_succeeded;
+}
+#endif
+
+BTS7960_HAL_MOCK_FUNCTION(bool, getEnablePinState)(BTS7960_HAL *const base, bool *const state) {
+  BTS7960_HAL_Mock *const hal = BTS7960_HAL_Mock_beginOperation(base);
+
   if (hal->should_get_enable_pin_state_succeed) {
     *state = hal->enable_pin_state;
   }
@@ -72,15 +138,39 @@ bool BTS7960_HAL_getEnablePinState(BTS7960_HAL *const hal, bool *const state) {
   return hal->should_get_enable_pin_state_succeed;
 }
 
-bool BTS7960_HAL_measureCurrentSenseVoltage(BTS7960_HAL *const hal, uint32_t *const voltage) {
+BTS7960_HAL_MOCK_FUNCTION(bool, measureCurrentSenseVoltage)(BTS7960_HAL *const base, uint32_t *const voltage) {
+  BTS7960_HAL_Mock *const hal = BTS7960_HAL_Mock_beginOperation(base);
+
   if (hal->should_measure_current_sense_voltage_succeed) {
-    *voltage = hal->current_sense_voltage;
+    if (hal->current_sense_voltage_stream_position < hal->current_sense_voltage_stream_length) {
+      *voltage = hal->current_sense_voltage_stream[hal->current_sense_voltage_stream_position++];
+    } else {
+      *voltage = hal->current_sense_voltage;
+    }
+
+    hal->current_sense_measurement_count++;
+
+#ifdef BTS7960_ENABLE_FREQUENCY_CONTROL
+    if (hal->current_sense_ripple_model) {
+      uint32_t const ripple = hal->current_sense_ripple_model(hal->pwm_signal_frequency, hal->pwm_signal_pecentage);
+
+      if (hal->current_sense_ripple_phase) {
+        *voltage += ripple / 2;
+      } else {
+        *voltage = (*voltage > ripple / 2) ? *voltage - ripple / 2 : 0;
+      }
+
+      hal->current_sense_ripple_phase = !hal->current_sense_ripple_phase;
+    }
+#endif
   }
 
   return hal->should_measure_current_sense_voltage_succeed;
 }
 
-bool BTS7960_HAL_setPwmSignalPercentage(BTS7960_HAL *const hal, uint8_t const percentage) {
+BTS7960_HAL_MOCK_FUNCTION(bool, setPwmSignalPercentage)(BTS7960_HAL *const base, uint8_t const percentage) {
+  BTS7960_HAL_Mock *const hal = BTS7960_HAL_Mock_beginOperation(base);
+
   if (hal->should_set_pwm_signal_percentage_succeed) {
     hal->pwm_signal_pecentage = percentage;
   }
@@ -88,7 +178,9 @@ bool BTS7960_HAL_setPwmSignalPercentage(BTS7960_HAL *const hal, uint8_t const pe
   return hal->should_set_pwm_signal_percentage_succeed;
 }
 
-bool BTS7960_HAL_getPwmSignalPercentage(BTS7960_HAL *const hal, uint8_t *const percentage) {
+BTS7960_HAL_MOCK_FUNCTION(bool, getPwmSignalPercentage)(BTS7960_HAL *const base, uint8_t *const percentage) {
+  BTS7960_HAL_Mock *const hal = BTS7960_HAL_Mock_beginOperation(base);
+
   if (hal->should_get_pwm_signal_percentage_succeed) {
     *percentage = hal->pwm_signal_pecentage;
   }
@@ -97,15 +189,29 @@ bool BTS7960_HAL_getPwmSignalPercentage(BTS7960_HAL *const hal, uint8_t *const p
 }
 
 #ifdef BTS7960_ENABLE_FREQUENCY_CONTROL
-BTS7960_HAL_FrequencyStatus BTS7960_HAL_setPwmSignalFrequency(BTS7960_HAL *const hal, uint32_t const frequency) {
-  if (hal->should_set_pwm_signal_frequency_succeed) {
-    hal->pwm_signal_frequency = frequency;
+BTS7960_HAL_MOCK_FUNCTION(BTS7960_HAL_FrequencyStatus, setPwmSignalFrequency)(BTS7960_HAL *const base,
+                                                                               uint32_t const     frequency) {
+  BTS7960_HAL_Mock *const hal = BTS7960_HAL_Mock_beginOperation(base);
+
+  if (frequency < hal->min_allowed_frequency) {
+    return BTS7960_HAL_FREQUENCY_TOO_LOW;
+  }
+
+  if (frequency > hal->max_allowed_frequency) {
+    return BTS7960_HAL_FREQUENCY_TOO_HIGH;
+  }
+
+  if (!hal->should_set_pwm_signal_frequency_succeed) {
+    return BTS7960_HAL_FREQUENCY_ERROR;
   }
 
-  return hal->should_set_pwm_signal_frequency_succeed;
+  hal->pwm_signal_frequency = frequency;
+  return BTS7960_HAL_FREQUENCY_OK;
 }
 
-bool BTS7960_HAL_getPwmSignalFrequency(BTS7960_HAL *const hal, uint32_t *const frequency) {
+BTS7960_HAL_MOCK_FUNCTION(bool, getPwmSignalFrequency)(BTS7960_HAL *const base, uint32_t *const frequency) {
+  BTS7960_HAL_Mock *const hal = BTS7960_HAL_Mock_beginOperation(base);
+
   if (hal->should_get_pwm_signal_frequency_succeed) {
     *frequency = hal->pwm_signal_frequency;
   }
@@ -113,3 +219,22 @@ bool BTS7960_HAL_getPwmSignalFrequency(BTS7960_HAL *const hal, uint32_t *const f
   return hal->should_get_pwm_signal_frequency_succeed;
 }
 #endif
+
+#ifdef BTS7960_ENABLE_RUNTIME_HAL
+BTS7960_HAL_Ops const BTS7960_HAL_MOCK_OPS = {
+  .initializeHardware         = BTS7960_HAL_Mock_initializeHardware,
+  .deInitializeHardware       = BTS7960_HAL_Mock_deInitializeHardware,
+  .setEnablePinState          = BTS7960_HAL_Mock_setEnablePinState,
+  .getEnablePinState          = BTS7960_HAL_Mock_getEnablePinState,
+  .measureCurrentSenseVoltage = BTS7960_HAL_Mock_measureCurrentSenseVoltage,
+  .setPwmSignalPercentage     = BTS7960_HAL_Mock_setPwmSignalPercentage,
+  .getPwmSignalPercentage     = BTS7960_HAL_Mock_getPwmSignalPercentage,
+  #ifdef BTS7960_ENABLE_FREQUENCY_CONTROL
+  .setPwmSignalFrequency = BTS7960_HAL_Mock_setPwmSignalFrequency,
+  .getPwmSignalFrequency = BTS7960_HAL_Mock_getPwmSignalFrequency,
+  #endif
+  #ifdef BTS7960_ENABLE_BATCHED_HAL
+  .setEnablePinStates = BTS7960_HAL_Mock_setEnablePinStates,
+  #endif
+};
+#endif
@@ -1,11 +1,14 @@
 /// @file mock.h
 /// BTS7960 HAL mock for testing and playing with.
 /// This mock functions as an fully-configurable software simulation of BTS7960 HAL.
+/// It supports both link-time and runtime HAL binding (see `bts7960_hal.h`). With runtime binding, set `base.ops` to
+/// `&BTS7960_HAL_MOCK_OPS` before use. Use BTS7960_HAL_Mock_toHal() to get HAL instance for the driver in both modes.
 #pragma once
 
 #include "../bts7960_hal.h"
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -16,9 +19,22 @@ extern "C"
 #ifdef BTS7960_ENABLE_FREQUENCY_CONTROL
   static uint32_t const BTS7960_HAL_MOCK_DEFAULT_MIN_ALLOWED_FREQUENCY = 1000;
   static uint32_t const BTS7960_HAL_MOCK_DEFAULT_MAX_ALLOWED_FREQUENCY = 100000;
+
+  /// Current sense ripple model.
+  /// Returns peak-to-peak ripple of current sense voltage (in millivolts) for given PWM frequency and duty cycle.
+  typedef uint32_t (*BTS7960_HAL_MockRippleModel)(uint32_t frequency, uint8_t percentage);
 #endif
 
+#ifdef BTS7960_ENABLE_RUNTIME_HAL
+  typedef struct BTS7960_HAL_Mock_t BTS7960_HAL_Mock;
+
+  struct BTS7960_HAL_Mock_t {
+    BTS7960_HAL base;  ///< Runtime HAL base, must be the first member.
+#else
+  typedef struct BTS7960_HAL_impl BTS7960_HAL_Mock;
+
   struct BTS7960_HAL_impl {
+#endif
     bool should_init_succeed;
     bool should_deinit_succeed;
     bool should_set_enable_pin_state_succeed;
@@ -31,15 +47,47 @@ extern "C"
     uint32_t max_allowed_frequency;
     bool     should_set_pwm_signal_frequency_succeed;
     bool     should_get_pwm_signal_frequency_succeed;
+
+    /// If set, measured current sense voltage oscillates around `current_sense_voltage` with the ripple returned by
+    /// this model, consecutive measurements alternate between the lower and upper peak.
+    BTS7960_HAL_MockRippleModel current_sense_ripple_model;
 #endif
     bool     enable_pin_state;
+    uint32_t enable_pin_state_timestamp;  ///< Mock clock value of the last `enable` pin change.
     uint32_t current_sense_voltage;
+    uint32_t current_sense_measurement_count;
     uint8_t  pwm_signal_pecentage;
+
+    /// If set, consecutive measurements return the values from this stream instead of `current_sense_voltage`, until
+    /// all `current_sense_voltage_stream_length` values are consumed.
+    uint32_t const *current_sense_voltage_stream;
+    size_t          current_sense_voltage_stream_length;
+    size_t          current_sense_voltage_stream_position;
 #ifdef BTS7960_ENABLE_FREQUENCY_CONTROL
     uint32_t pwm_signal_frequency;
+    bool     current_sense_ripple_phase;
 #endif
   };
 
+  /// Returns mock clock value. The clock is shared by all mock instances and advanced by every mock HAL operation, so
+  /// the difference between timestamps is expressed in HAL operations.
+  uint32_t BTS7960_HAL_Mock_getClock(void);
+
+#ifdef BTS7960_ENABLE_RUNTIME_HAL
+  /// Mock HAL operations table.
+  extern BTS7960_HAL_Ops const BTS7960_HAL_MOCK_OPS;
+
+  /// Returns HAL instance of the mock, to be passed to the driver.
+  static inline BTS7960_HAL *BTS7960_HAL_Mock_toHal(BTS7960_HAL_Mock *const mock) { return &mock->base; }
+
+  /// Returns the mock owning HAL instance.
+  static inline BTS7960_HAL_Mock *BTS7960_HAL_Mock_fromHal(BTS7960_HAL *const hal) { return (BTS7960_HAL_Mock *)hal; }
+#else
+  static inline BTS7960_HAL *BTS7960_HAL_Mock_toHal(BTS7960_HAL_Mock *const mock) { return mock; }
+
+  static inline BTS7960_HAL_Mock *BTS7960_HAL_Mock_fromHal(BTS7960_HAL *const hal) { return hal; }
+#endif
+
 #ifdef __cplusplus
 }
 #endif
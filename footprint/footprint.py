@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+"""Code-size and RAM footprint report for BTS7960 driver variants.
+
+For every variant, the size-optimized driver library is inspected with `size` (Berkeley format), and the `sizeof`
+of public structures is taken from the compiler by meson at configure time. Budgets are checked only against the
+driver object and the driver instance, as HAL is user-provided and measured only for reference.
+
+Returns non-zero exit code if any of the budgets is exceeded.
+"""
+
+import argparse
+import subprocess
+import sys
+from pathlib import Path
+
+DRIVER_OBJECT_SUFFIX = "bts7960.c.o"
+DRIVER_OBJECT_SUFFIX_MSVC = "bts7960.c.obj"
+
+
+def measure_sections(size_tool: str, library: str) -> dict[str, tuple[int, int, int]]:
+    """Returns (text, data, bss) sizes for every object file in the library."""
+    output = subprocess.run([size_tool, library], check=True, capture_output=True, text=True).stdout
+    sections = {}
+    for line in output.splitlines()[1:]:
+        columns = line.split(maxsplit=5)
+        if len(columns) < 6:
+            continue
+        # Archive members are listed as `<object> (ex <archive>)`.
+        object_name = Path(columns[5].split(" (ex ")[0]).name
+        sections[object_name] = (int(columns[0]), int(columns[1]), int(columns[2]))
+    return sections
+
+
+def parse_types(types: str) -> dict[str, int]:
+    """Returns sizes of public structures from comma-separated `<type>=<size in bytes>` list."""
+    return {name: int(size) for name, size in (entry.split("=") for entry in types.split(",") if entry)}
+
+
+def is_driver_object(object_name: str) -> bool:
+    return object_name.endswith(DRIVER_OBJECT_SUFFIX) or object_name.endswith(DRIVER_OBJECT_SUFFIX_MSVC)
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--size", required=True, help="path to `size` tool")
+    parser.add_argument("--text-budget", type=int, required=True, help="max driver .text size, in bytes")
+    parser.add_argument("--data-budget", type=int, required=True, help="max driver .data size, in bytes")
+    parser.add_argument("--bss-budget", type=int, required=True, help="max driver .bss size, in bytes")
+    parser.add_argument("--instance-budget", type=int, required=True, help="max sizeof(BTS7960), in bytes")
+    parser.add_argument("--variant",
+                        nargs=3,
+                        action="append",
+                        default=[],
+                        metavar=("NAME", "LIBRARY", "TYPES"),
+                        help="variant to measure")
+    args = parser.parse_args()
+
+    budgets = (args.text_budget, args.data_budget, args.bss_budget)
+    violations = []
+
+    for name, library, type_sizes in args.variant:
+        sections = measure_sections(args.size, library)
+        types = parse_types(type_sizes)
+
+        print(f"{name}:")
+        print(f"  {'object':<32}{'text':>8}{'data':>8}{'bss':>8}")
+        for object_name, sizes in sorted(sections.items()):
+            print(f"  {object_name:<32}{sizes[0]:>8}{sizes[1]:>8}{sizes[2]:>8}")
+            if not is_driver_object(object_name):
+                continue
+            for section, size, budget in zip(("text", "data", "bss"), sizes, budgets):
+                if size > budget:
+                    violations.append(f"{name}: driver .{section} is {size} bytes, budget is {budget}")
+
+        for type_name, size in types.items():
+            print(f"  sizeof({type_name}) = {size}")
+        if types.get("BTS7960", 0) > args.instance_budget:
+            violations.append(f"{name}: sizeof(BTS7960) is {types['BTS7960']} bytes, budget is {args.instance_budget}")
+        print()
+
+    for violation in violations:
+        print(f"BUDGET EXCEEDED - {violation}", file=sys.stderr)
+
+    return 1 if violations else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -3,19 +3,28 @@
 #include <bts7960/bts7960.h>
 #include <bts7960/hal/mock.h>
 
+#include <algorithm>
+
+#ifdef BTS7960_ENABLE_RUNTIME_HAL
+  #include <bts7960/hal/memory.h>
+#endif
+
 TEST_GROUP(BTS7960) {
-  static inline BTS7960     bts;
-  static inline BTS7960_HAL hal;
+  static inline BTS7960          bts;
+  static inline BTS7960_HAL_Mock hal;
 
   void setup() {
+#ifdef BTS7960_ENABLE_RUNTIME_HAL
+    hal.base.ops = &BTS7960_HAL_MOCK_OPS;
+#endif
     hal.should_init_succeed = true;
-    BTS7960_HAL_initializeHardware(&hal);
-    BTS7960_initialize(&bts, &hal);
+    BTS7960_HAL_initializeHardware(BTS7960_HAL_Mock_toHal(&hal));
+    BTS7960_initialize(&bts, BTS7960_HAL_Mock_toHal(&hal));
   }
 
   void teardown() {
     BTS7960_deInitialize(&bts);
-    BTS7960_HAL_deInitializeHardware(&hal);
+    BTS7960_HAL_deInitializeHardware(BTS7960_HAL_Mock_toHal(&hal));
   }
 };
 
@@ -26,24 +35,432 @@ TEST(BTS7960, initializesCorrectly) {
   // BTS should be properly initialized in setup(), so only thing to do is
   // to check the fields.
   CHECK_TRUE(bts.is_initialized);
-  POINTERS_EQUAL(&hal, bts.hal);
+  POINTERS_EQUAL(BTS7960_HAL_Mock_toHal(&hal), bts.hal);
+
+  // Fault voltage is defined as a voltage drop on current sense resistor @ fault current.
+  // Fault voltage epsilon is defined as accepted voltage deviation from fault voltage to be clasified as a fault.
+  uint32_t const expected_fault_voltage
+    = BTS7960_DEFAULT_CURRENT_SENSE_RESISTANCE * BTS7960_DEFAULT_CURRENT_IN_FAULT_MODE / 1000;
+  uint32_t const expected_fault_voltage_epsilon
+    = expected_fault_voltage * BTS7960_DEFAULT_FAULT_VOLTAGE_TOLERANCE / 100;
+  UNSIGNED_LONGS_EQUAL(expected_fault_voltage - expected_fault_voltage_epsilon, bts.fault_voltage_min);
+
+  // Current sense multiplier is defined as current sense ratio * current sense resistance / 1000
+  uint32_t const expected_current_sense_multiplier
+    = BTS7960_DEFAULT_CURRENT_SENSE_RATIO * BTS7960_DEFAULT_CURRENT_SENSE_RESISTANCE / 1000;
+  UNSIGNED_LONGS_EQUAL(expected_current_sense_multiplier, bts.current_sense_multiplier);
+
+#ifndef BTS7960_DISABLE_CONFIGURATION_STORAGE
   UNSIGNED_LONGS_EQUAL(BTS7960_DEFAULT_CURRENT_SENSE_RESISTANCE, bts.current_sense_resistance);
   UNSIGNED_LONGS_EQUAL(BTS7960_DEFAULT_CURRENT_SENSE_RATIO, bts.current_sense_ratio);
   UNSIGNED_LONGS_EQUAL(BTS7960_DEFAULT_CURRENT_IN_FAULT_MODE, bts.current_in_fault_mode);
   UNSIGNED_LONGS_EQUAL(BTS7960_DEFAULT_FAULT_VOLTAGE_TOLERANCE, bts.fault_voltage_tolerance);
-
-  // Fault voltage is defined as a voltage drop on current sense resistor @ fault current.
-  uint32_t const expected_fault_voltage = bts.current_sense_resistance * bts.current_in_fault_mode / 1000;
   UNSIGNED_LONGS_EQUAL(expected_fault_voltage, bts.fault_voltage);
-
-  // Fault voltage epsilon is defined as accepted voltage deviation from fault voltage to be clasified as a fault.
-  uint32_t const expected_fault_voltage_epsilon = bts.fault_voltage * bts.fault_voltage_tolerance / 100;
   UNSIGNED_LONGS_EQUAL(expected_fault_voltage_epsilon, bts.fault_voltage_epsilon);
-  UNSIGNED_LONGS_EQUAL(bts.fault_voltage - bts.fault_voltage_epsilon, bts.fault_voltage_min);
+#endif
+}
 
-  // Current sense multiplier is defined as current sense ratio * current sense resistance / 1000
-  uint32_t const expected_current_sense_multiplier = bts.current_sense_ratio * bts.current_sense_resistance / 1000;
-  UNSIGNED_LONGS_EQUAL(expected_current_sense_multiplier, bts.current_sense_multiplier);
+#ifdef BTS7960_ENABLE_EMERGENCY_STOP
+/// Initializes mock HAL and driver instances, in addition to the ones from test group.
+static void initializeMockDrivers(BTS7960_HAL_Mock *const hals, BTS7960 *const drivers, size_t const count) {
+  for (size_t index = 0; index < count; index++) {
+#ifdef BTS7960_ENABLE_RUNTIME_HAL
+    hals[index].base.ops = &BTS7960_HAL_MOCK_OPS;
+#endif
+    hals[index].should_init_succeed = true;
+    BTS7960_HAL_initializeHardware(BTS7960_HAL_Mock_toHal(&hals[index]));
+    BTS7960_initialize(&drivers[index], BTS7960_HAL_Mock_toHal(&hals[index]));
+  }
+}
+
+/// Given a group of three enabled drivers,
+/// When BTS7960_emergencyStop() is called,
+/// Then all drivers are disabled within the reported worst-case amount of HAL operations, at the same time if the
+/// group is batched, or one HAL operation apart otherwise.
+TEST(BTS7960, emergencyStopDisablesWholeGroup) {
+  BTS7960_HAL_Mock channel_hals[2] = {};
+  BTS7960          channels[2]     = {};
+  initializeMockDrivers(channel_hals, channels, 2);
+
+  BTS7960 *const    drivers[] = {&bts, &channels[0], &channels[1]};
+  BTS7960_HAL      *hals[3]   = {};
+  BTS7960_Group     group     = {};
+  BTS7960_HAL_Mock *mocks[]   = {&hal, &channel_hals[0], &channel_hals[1]};
+
+  LONGS_EQUAL(BTS7960_OK, BTS7960_initializeGroup(&group, drivers, hals, 3));
+#ifdef BTS7960_ENABLE_BATCHED_HAL
+  CHECK_TRUE(group.is_batched);
+  UNSIGNED_LONGS_EQUAL(4, group.worst_case_hal_operations);
+#else
+  CHECK_FALSE(group.is_batched);
+  UNSIGNED_LONGS_EQUAL(3, group.worst_case_hal_operations);
+#endif
+
+  for (BTS7960 *const driver : drivers) {
+    LONGS_EQUAL(BTS7960_OK, BTS7960_enable(driver));
+  }
+
+  uint32_t const start = BTS7960_HAL_Mock_getClock();
+  LONGS_EQUAL(BTS7960_OK, BTS7960_emergencyStop(&group));
+  CHECK_TRUE(BTS7960_HAL_Mock_getClock() - start <= group.worst_case_hal_operations);
+
+  uint32_t first_shutdown = UINT32_MAX;
+  uint32_t last_shutdown  = 0;
+
+  for (BTS7960_HAL_Mock *const mock : mocks) {
+    CHECK_FALSE(mock->enable_pin_state);
+    first_shutdown = std::min(first_shutdown, mock->enable_pin_state_timestamp);
+    last_shutdown  = std::max(last_shutdown, mock->enable_pin_state_timestamp);
+  }
+
+#ifdef BTS7960_ENABLE_BATCHED_HAL
+  UNSIGNED_LONGS_EQUAL(0, last_shutdown - first_shutdown);
+#else
+  UNSIGNED_LONGS_EQUAL(2, last_shutdown - first_shutdown);
+#endif
+}
+
+/// Given a group of three enabled drivers, where the middle one can't be disabled,
+/// When BTS7960_emergencyStop() is called,
+/// Then BTS7960_HAL_ERROR is returned, but the remaining drivers are still disabled.
+TEST(BTS7960, emergencyStopDisablesRemainingDriversOnFailure) {
+  BTS7960_HAL_Mock channel_hals[2] = {};
+  BTS7960          channels[2]     = {};
+  initializeMockDrivers(channel_hals, channels, 2);
+
+  BTS7960 *const drivers[] = {&bts, &channels[0], &channels[1]};
+  BTS7960_HAL   *hals[3]   = {};
+  BTS7960_Group  group     = {};
+
+  LONGS_EQUAL(BTS7960_OK, BTS7960_initializeGroup(&group, drivers, hals, 3));
+
+  for (BTS7960 *const driver : drivers) {
+    LONGS_EQUAL(BTS7960_OK, BTS7960_enable(driver));
+  }
+
+  channel_hals[0].should_set_enable_pin_state_succeed = false;
+
+  uint32_t const start = BTS7960_HAL_Mock_getClock();
+  LONGS_EQUAL(BTS7960_HAL_ERROR, BTS7960_emergencyStop(&group));
+  UNSIGNED_LONGS_EQUAL(group.worst_case_hal_operations, BTS7960_HAL_Mock_getClock() - start);
+  CHECK_FALSE(hal.enable_pin_state);
+  CHECK_TRUE(channel_hals[0].enable_pin_state);
+  CHECK_FALSE(channel_hals[1].enable_pin_state);
+}
+
+/// Given an uninitialized driver,
+/// When BTS7960_initializeGroup() is called with it,
+/// Then BTS7960_NOT_INITIALIZED is returned.
+TEST(BTS7960, initializeGroupRejectsUninitializedDriver) {
+  BTS7960        uninitialized = {};
+  BTS7960 *const drivers[]     = {&bts, &uninitialized};
+  BTS7960_HAL   *hals[2]       = {};
+  BTS7960_Group  group         = {};
+
+  LONGS_EQUAL(BTS7960_NOT_INITIALIZED, BTS7960_initializeGroup(&group, drivers, hals, 2));
+}
+
+#endif
+
+#if defined(BTS7960_ENABLE_RUNTIME_HAL) && defined(BTS7960_ENABLE_BATCHED_HAL)
+/// Given drivers using mock and in-memory HAL, that doesn't support batched operations,
+/// When BTS7960_initializeGroup() is called with them,
+/// Then the group falls back to disabling drivers one by one.
+TEST(BTS7960, initializeGroupWithMixedHalsIsNotBatched) {
+  BTS7960_HAL_Memory memory     = {};
+  BTS7960            memory_bts = {};
+  memory.base.ops               = &BTS7960_HAL_MEMORY_OPS;
+  BTS7960_initialize(&memory_bts, &memory.base);
+
+  BTS7960 *const drivers[] = {&bts, &memory_bts};
+  BTS7960_HAL   *hals[2]   = {};
+  BTS7960_Group  group     = {};
+
+  LONGS_EQUAL(BTS7960_OK, BTS7960_initializeGroup(&group, drivers, hals, 2));
+  CHECK_FALSE(group.is_batched);
+  UNSIGNED_LONGS_EQUAL(2, group.worst_case_hal_operations);
+
+  BTS7960_enable(&bts);
+  BTS7960_enable(&memory_bts);
+  LONGS_EQUAL(BTS7960_OK, BTS7960_emergencyStop(&group));
+  CHECK_FALSE(hal.enable_pin_state);
+  CHECK_FALSE(memory.enable_pin_state);
+}
+#endif
+
+#ifdef BTS7960_ENABLE_FREQUENCY_CONTROL
+/// Ripple model with minimum at 20kHz, rising towards both ends of the frequency range.
+static uint32_t rippleModelWithMinimumAt20kHz(uint32_t frequency, uint8_t /* percentage */) {
+  uint32_t const distance = (frequency > 20000) ? frequency - 20000 : 20000 - frequency;
+  return 20 + 2 * (distance / 1000);
+}
+
+/// Ripple model returning the same ripple for every frequency.
+static uint32_t flatRippleModel(uint32_t /* frequency */, uint8_t /* percentage */) { return 40; }
+
+/// Given an initialized driver and HAL with ripple model that has a minimum at 20kHz,
+/// When BTS7960_tuneOutputFrequency() sweeps the whole allowed frequency range,
+/// Then 20kHz is picked and set, duty cycle is restored and each step takes exactly `samples_per_step` measurements.
+TEST(BTS7960, tuneOutputFrequencyPicksLowestRipple) {
+  hal.current_sense_voltage      = 100;
+  hal.current_sense_ripple_model = rippleModelWithMinimumAt20kHz;
+  hal.pwm_signal_pecentage       = 30;
+
+  BTS7960_FrequencySweep const sweep  = {1000, 100000, 1000, 4, 50};
+  BTS7960_FrequencySweepResult result = {};
+
+  LONGS_EQUAL(BTS7960_OK, BTS7960_tuneOutputFrequency(&bts, &sweep, &result));
+  UNSIGNED_LONGS_EQUAL(20000, result.frequency);
+  UNSIGNED_LONGS_EQUAL(20 * bts.current_sense_multiplier, result.ripple);
+  UNSIGNED_LONGS_EQUAL(20000, hal.pwm_signal_frequency);
+  UNSIGNED_LONGS_EQUAL(30, hal.pwm_signal_pecentage);
+  UNSIGNED_LONGS_EQUAL(100 * 4, hal.current_sense_measurement_count);
+}
+
+/// Given an initialized driver and HAL that accepts frequencies only in [10kHz, 30kHz] range,
+/// When BTS7960_tuneOutputFrequency() sweeps wider range with flat ripple,
+/// Then frequencies outside of HAL limits are not measured, and the lowest accepted frequency is picked on ties.
+TEST(BTS7960, tuneOutputFrequencyStaysWithinHalLimits) {
+  hal.current_sense_voltage      = 100;
+  hal.current_sense_ripple_model = flatRippleModel;
+  hal.min_allowed_frequency      = 10000;
+  hal.max_allowed_frequency      = 30000;
+
+  BTS7960_FrequencySweep const sweep  = {5000, 50000, 5000, 2, 50};
+  BTS7960_FrequencySweepResult result = {};
+
+  LONGS_EQUAL(BTS7960_OK, BTS7960_tuneOutputFrequency(&bts, &sweep, &result));
+  UNSIGNED_LONGS_EQUAL(10000, result.frequency);
+  UNSIGNED_LONGS_EQUAL(10000, hal.pwm_signal_frequency);
+  // 10, 15, 20, 25 and 30kHz are accepted by HAL.
+  UNSIGNED_LONGS_EQUAL(5 * 2, hal.current_sense_measurement_count);
+}
+
+/// Given an initialized driver and HAL that accepts frequencies only in [10kHz, 30kHz] range,
+/// When BTS7960_tuneOutputFrequency() sweeps the range outside of HAL limits,
+/// Then the sweep fails with matching error and the previous frequency is kept.
+TEST(BTS7960, tuneOutputFrequencyFailsOutsideOfHalLimits) {
+  hal.min_allowed_frequency = 10000;
+  hal.max_allowed_frequency = 30000;
+  hal.pwm_signal_frequency  = 15000;
+
+  BTS7960_FrequencySweep       sweep  = {1000, 9000, 1000, 4, 50};
+  BTS7960_FrequencySweepResult result = {};
+
+  LONGS_EQUAL(BTS7960_ERROR_FREQUENCY_TOO_LOW, BTS7960_tuneOutputFrequency(&bts, &sweep, &result));
+  UNSIGNED_LONGS_EQUAL(0, result.frequency);
+
+  sweep.min_frequency = 31000;
+  sweep.max_frequency = 40000;
+  LONGS_EQUAL(BTS7960_ERROR_FREQUENCY_TOO_HIGH, BTS7960_tuneOutputFrequency(&bts, &sweep, &result));
+  UNSIGNED_LONGS_EQUAL(0, result.frequency);
+
+  UNSIGNED_LONGS_EQUAL(15000, hal.pwm_signal_frequency);
+  UNSIGNED_LONGS_EQUAL(0, hal.current_sense_measurement_count);
+}
+
+/// Given an initialized driver and HAL that accepts frequencies only in [20kHz, 21kHz] range,
+/// When BTS7960_tuneOutputFrequency() sweeps the whole 32-bit frequency range with 1Hz step,
+/// Then the sweep reaches the frequencies accepted by HAL and picks the one with the lowest ripple.
+TEST(BTS7960, tuneOutputFrequencySweepsFullRange) {
+  hal.current_sense_voltage      = 100;
+  hal.current_sense_ripple_model = rippleModelWithMinimumAt20kHz;
+  hal.min_allowed_frequency      = 20000;
+  hal.max_allowed_frequency      = 21000;
+
+  BTS7960_FrequencySweep const sweep  = {0, UINT32_MAX, 1, 2, 50};
+  BTS7960_FrequencySweepResult result = {};
+
+  LONGS_EQUAL(BTS7960_OK, BTS7960_tuneOutputFrequency(&bts, &sweep, &result));
+  UNSIGNED_LONGS_EQUAL(20000, result.frequency);
+  UNSIGNED_LONGS_EQUAL(20000, hal.pwm_signal_frequency);
+  UNSIGNED_LONGS_EQUAL(1001 * 2, hal.current_sense_measurement_count);
+}
+
+/// Given an initialized driver and HAL that accepts every frequency,
+/// When BTS7960_tuneOutputFrequency() sweeps the range ending at UINT32_MAX,
+/// Then the last step is measured and the sweep terminates.
+TEST(BTS7960, tuneOutputFrequencySweepsUpToMaxFrequency) {
+  hal.current_sense_voltage      = 100;
+  hal.current_sense_ripple_model = flatRippleModel;
+  hal.min_allowed_frequency      = 0;
+  hal.max_allowed_frequency      = UINT32_MAX;
+
+  BTS7960_FrequencySweep const sweep  = {UINT32_MAX - 2, UINT32_MAX, 1, 2, 50};
+  BTS7960_FrequencySweepResult result = {};
+
+  LONGS_EQUAL(BTS7960_OK, BTS7960_tuneOutputFrequency(&bts, &sweep, &result));
+  UNSIGNED_LONGS_EQUAL(UINT32_MAX - 2, result.frequency);
+  UNSIGNED_LONGS_EQUAL(3 * 2, hal.current_sense_measurement_count);
+}
+
+/// Given an initialized driver and HAL that fails to set PWM frequency,
+/// When BTS7960_tuneOutputFrequency() is called,
+/// Then the sweep fails with BTS7960_HAL_ERROR instead of out-of-range frequency error, and the duty cycle is restored.
+TEST(BTS7960, tuneOutputFrequencyFailsOnHalError) {
+  hal.should_set_pwm_signal_frequency_succeed = false;
+  hal.pwm_signal_pecentage                    = 30;
+
+  BTS7960_FrequencySweep const sweep  = {1000, 100000, 1000, 4, 80};
+  BTS7960_FrequencySweepResult result = {};
+
+  LONGS_EQUAL(BTS7960_HAL_ERROR, BTS7960_tuneOutputFrequency(&bts, &sweep, &result));
+  UNSIGNED_LONGS_EQUAL(0, result.frequency);
+  UNSIGNED_LONGS_EQUAL(0, hal.current_sense_measurement_count);
+  UNSIGNED_LONGS_EQUAL(30, hal.pwm_signal_pecentage);
+  LONGS_EQUAL(BTS7960_HAL_ERROR, BTS7960_setOutputFrequency(&bts, 20000));
+}
+
+/// Given an initialized driver and HAL reporting fault voltage on current sense pin,
+/// When BTS7960_tuneOutputFrequency() is called,
+/// Then the sweep stops at the first measurement with BTS7960_FAULT_DETECTED and the previous settings are restored.
+TEST(BTS7960, tuneOutputFrequencyStopsOnFault) {
+  hal.current_sense_voltage = bts.fault_voltage_min;
+  hal.pwm_signal_frequency  = 15000;
+  hal.pwm_signal_pecentage  = 30;
+
+  BTS7960_FrequencySweep const sweep  = {1000, 100000, 1000, 4, 50};
+  BTS7960_FrequencySweepResult result = {};
+
+  LONGS_EQUAL(BTS7960_FAULT_DETECTED, BTS7960_tuneOutputFrequency(&bts, &sweep, &result));
+  UNSIGNED_LONGS_EQUAL(0, result.frequency);
+  UNSIGNED_LONGS_EQUAL(15000, hal.pwm_signal_frequency);
+  UNSIGNED_LONGS_EQUAL(30, hal.pwm_signal_pecentage);
+  UNSIGNED_LONGS_EQUAL(1, hal.current_sense_measurement_count);
+}
+#endif
+
+#ifdef BTS7960_ENABLE_EVENTS
+/// Records the events reported by the driver.
+struct EventRecorder {
+  BTS7960_Event events[16];
+  size_t        count;
+};
+
+static void recordEvent(BTS7960 * /* bts */, BTS7960_Event event, void *context) {
+  EventRecorder *const recorder = static_cast<EventRecorder *>(context);
+
+  if (recorder->count < sizeof(recorder->events) / sizeof(recorder->events[0])) {
+    recorder->events[recorder->count] = event;
+  }
+
+  recorder->count++;
+}
+
+/// Given an initialized driver with event handler and current threshold set,
+/// When a stream of current sense voltages crossing the threshold and fault voltage is sampled,
+/// Then every crossing is reported exactly once, and threshold is not evaluated in fault mode.
+TEST(BTS7960, sampleCurrentSenseReportsEachEdgeOnce) {
+  EventRecorder              recorder = {};
+  BTS7960_EventHandler const handler  = {recordEvent, &recorder};
+  LONGS_EQUAL(BTS7960_OK, BTS7960_setEventHandler(&bts, &handler));
+
+  // Threshold of 100mV on current sense pin.
+  uint32_t const threshold_voltage = 100;
+  LONGS_EQUAL(BTS7960_OK, BTS7960_setCurrentThreshold(&bts, threshold_voltage * bts.current_sense_multiplier));
+  UNSIGNED_LONGS_EQUAL(threshold_voltage, bts.current_threshold);
+
+  uint32_t const fault_voltage = bts.fault_voltage_min;
+  uint32_t const stream[]      = {
+    0, 50, 100, 150, 120, 99, 50, fault_voltage, fault_voltage + 10, 0, 120, 130, 20, 0,
+  };
+  hal.current_sense_voltage_stream        = stream;
+  hal.current_sense_voltage_stream_length = sizeof(stream) / sizeof(stream[0]);
+
+  for (size_t sample = 0; sample < hal.current_sense_voltage_stream_length; sample++) {
+    BTS7960_sampleCurrentSense(&bts);
+  }
+
+  BTS7960_Event const expected_events[] = {
+    BTS7960_EVENT_CURRENT_ABOVE_THRESHOLD,
+    BTS7960_EVENT_CURRENT_BELOW_THRESHOLD,
+    BTS7960_EVENT_FAULT_ENTERED,
+    BTS7960_EVENT_FAULT_CLEARED,
+    BTS7960_EVENT_CURRENT_ABOVE_THRESHOLD,
+    BTS7960_EVENT_CURRENT_BELOW_THRESHOLD,
+  };
+
+  UNSIGNED_LONGS_EQUAL(sizeof(expected_events) / sizeof(expected_events[0]), recorder.count);
+  for (size_t event = 0; event < recorder.count; event++) {
+    LONGS_EQUAL(expected_events[event], recorder.events[event]);
+  }
+}
+
+/// Given an initialized driver with event handler set,
+/// When a fault voltage is processed,
+/// Then BTS7960_FAULT_DETECTED is returned for every sample, but the fault is reported only once.
+TEST(BTS7960, processCurrentSenseVoltageReportsFaultOnce) {
+  EventRecorder              recorder = {};
+  BTS7960_EventHandler const handler  = {recordEvent, &recorder};
+  BTS7960_setEventHandler(&bts, &handler);
+
+  LONGS_EQUAL(BTS7960_FAULT_DETECTED, BTS7960_processCurrentSenseVoltage(&bts, bts.fault_voltage_min));
+  LONGS_EQUAL(BTS7960_FAULT_DETECTED, BTS7960_processCurrentSenseVoltage(&bts, bts.fault_voltage_min));
+  LONGS_EQUAL(BTS7960_OK, BTS7960_processCurrentSenseVoltage(&bts, 0));
+
+  UNSIGNED_LONGS_EQUAL(2, recorder.count);
+  LONGS_EQUAL(BTS7960_EVENT_FAULT_ENTERED, recorder.events[0]);
+  LONGS_EQUAL(BTS7960_EVENT_FAULT_CLEARED, recorder.events[1]);
+}
+
+/// Given an initialized driver with event handler set and HAL failing to measure current sense voltage,
+/// When BTS7960_sampleCurrentSense() is called,
+/// Then BTS7960_HAL_ERROR is returned and reported with an event.
+TEST(BTS7960, sampleCurrentSenseReportsHalError) {
+  EventRecorder              recorder = {};
+  BTS7960_EventHandler const handler  = {recordEvent, &recorder};
+  BTS7960_setEventHandler(&bts, &handler);
+  hal.should_measure_current_sense_voltage_succeed = false;
+
+  LONGS_EQUAL(BTS7960_HAL_ERROR, BTS7960_sampleCurrentSense(&bts));
+  UNSIGNED_LONGS_EQUAL(1, recorder.count);
+  LONGS_EQUAL(BTS7960_EVENT_HAL_ERROR, recorder.events[0]);
+}
+
+/// Given a driver initialized with current sense resistance and ratio too low for non-zero current sense multiplier,
+/// When BTS7960_setCurrentThreshold() is called,
+/// Then BTS7960_INTERNAL_ERROR is returned and threshold events stay disabled.
+TEST(BTS7960, setCurrentThresholdFailsWithoutCurrentSenseMultiplier) {
+  BTS7960_deInitialize(&bts);
+  LONGS_EQUAL(BTS7960_OK, BTS7960_advancedInitialize(&bts, BTS7960_HAL_Mock_toHal(&hal), 1, 1, 1, 0));
+  UNSIGNED_LONGS_EQUAL(0, bts.current_sense_multiplier);
+
+  LONGS_EQUAL(BTS7960_INTERNAL_ERROR, BTS7960_setCurrentThreshold(&bts, 1000));
+  UNSIGNED_LONGS_EQUAL(0, bts.current_threshold);
+}
+#endif
+
+#ifdef BTS7960_ENABLE_RUNTIME_HAL
+/// Given a driver instance using mock HAL,
+/// When another driver instance is initialized with in-memory HAL in the same binary,
+/// Then each instance controls only its own backend.
+TEST(BTS7960, runtimeHalDrivesDifferentBackends) {
+  BTS7960_HAL_Memory memory     = {};
+  BTS7960            memory_bts = {};
+  memory.base.ops               = &BTS7960_HAL_MEMORY_OPS;
+
+  LONGS_EQUAL(BTS7960_OK, BTS7960_initialize(&memory_bts, &memory.base));
+  CHECK_TRUE(memory.is_initialized);
+
+  LONGS_EQUAL(BTS7960_OK, BTS7960_enable(&memory_bts));
+  LONGS_EQUAL(BTS7960_OK, BTS7960_setPowerPercentage(&memory_bts, 40));
+  CHECK_TRUE(memory.enable_pin_state);
+  UNSIGNED_LONGS_EQUAL(40, memory.pwm_signal_percentage);
+  CHECK_FALSE(hal.enable_pin_state);
+  UNSIGNED_LONGS_EQUAL(0, hal.pwm_signal_pecentage);
+
+  LONGS_EQUAL(BTS7960_OK, BTS7960_enable(&bts));
+  LONGS_EQUAL(BTS7960_OK, BTS7960_setPowerPercentage(&bts, 70));
+  CHECK_TRUE(hal.enable_pin_state);
+  UNSIGNED_LONGS_EQUAL(70, hal.pwm_signal_pecentage);
+  UNSIGNED_LONGS_EQUAL(40, memory.pwm_signal_percentage);
+
+  // initialize, enable, setPowerPercentage
+  UNSIGNED_LONGS_EQUAL(3, memory.operation_count);
+
+  LONGS_EQUAL(BTS7960_OK, BTS7960_deInitialize(&memory_bts));
+  CHECK_FALSE(memory.is_initialized);
 }
+#endif
 
 int main(int ac, char **av) { return CommandLineTestRunner::RunAllTests(ac, av); }